@@ -336,6 +336,20 @@ void HeadObject(qcloud_cos::CosAPI& cos, const std::string& bucket_name,
     std::cout << "==========================================================" << std::endl;
 }
 
+void HeadObjectAsync(qcloud_cos::CosAPI& cos, const std::string& bucket_name,
+                     const std::string& object_name) {
+    qcloud_cos::HeadObjectReq req(bucket_name, object_name);
+    qcloud_cos::HeadObjectResp resp;
+
+    // resp需要在请求完成前保持有效
+    qcloud_cos::AsyncFuture future = cos.HeadObjectAsync(req, &resp);
+    qcloud_cos::CosResult result = future.get();
+
+    std::cout << "===================HeadObjectAsyncResponse=====================" << std::endl;
+    PrintResult(result, resp);
+    std::cout << "===============================================================" << std::endl;
+}
+
 void GetObjectByFile(qcloud_cos::CosAPI& cos, const std::string& bucket_name,
                      const std::string& object_name, const std::string& file_path) {
     qcloud_cos::GetObjectByFileReq req(bucket_name, object_name, file_path);
@@ -462,6 +476,19 @@ void MultiUploadObject(qcloud_cos::CosAPI& cos, const std::string& bucket_name,
     std::cout << "========================================================" << std::endl;
 }
 
+// 从标准输入分块上传, 例如: mysqldump db | ./cos_demo
+void MultiUploadObjectByStream(qcloud_cos::CosAPI& cos, const std::string& bucket_name,
+                               const std::string& object_name) {
+    qcloud_cos::MultiUploadObjectByStreamReq req(bucket_name, object_name, std::cin);
+    req.SetRecvTimeoutInms(1000 * 60);
+    qcloud_cos::MultiUploadObjectResp resp;
+    qcloud_cos::CosResult result = cos.MultiUploadObject(req, &resp);
+
+    std::cout << "===================MultiUploadByStream=====================" << std::endl;
+    PrintResult(result, resp);
+    std::cout << "========================================================" << std::endl;
+}
+
 void ListParts(qcloud_cos::CosAPI& cos, const std::string& bucket_name,
                const std::string& object_name, const std::string& upload_id) {
     qcloud_cos::ListPartsReq req(bucket_name, object_name, upload_id);
@@ -1041,6 +1068,7 @@ int main(int argc, char** argv) {
     // PutObjectByFile(cos, bucket_name, "sevenyounorthtest2_normal", "/data/sevenyou/temp/seven_0821_10M");
     //PutObjectByFile(cos, bucket_name, "sevenyou_e2_north_put", "/data/sevenyou/temp/seven_0821_10M");
     // HeadObject(cos, bucket_name, "sevenyou_1102_north.jpg");
+    // HeadObjectAsync(cos, bucket_name, "sevenyou_1102_north.jpg");
     //GetObjectByFile(cos, bucket_name, "costest.php", "/data/sevenyou/temp/costest.php");
     //PutObjectByFile(cos, bucket_name, "sevenyou_e2_north_put", "/data/sevenyou/temp/seven_0821_10M");
     //// 简单上传(文件),特殊字符
@@ -1117,6 +1145,7 @@ int main(int argc, char** argv) {
 
     // //MultiUploadObject(cos, bucket_name, "sevenyou_e2_multi", "/data/sevenyou/temp/seven_50M.tmp.0925");
     // //MultiUploadObject(cos, bucket_name, "sevenyou_1102_north_multi", "/data/sevenyou/temp/seven_50M.tmp.0925");
+    // //MultiUploadObjectByStream(cos, bucket_name, "sevenyou_stream_multi");
 
 
     // //PutObjectACL(cos, bucket_name, "sevenyou_10m");
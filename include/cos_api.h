@@ -7,9 +7,14 @@
 #include "op/service_op.h"
 #include "util/simple_mutex.h"
 #include "Poco/SharedPtr.h"
+#include "boost/function.hpp"
+#include "boost/thread/future.hpp"
 
 namespace qcloud_cos {
 
+/// \brief 异步接口返回的future, 通过wait()/get()等待并获取本次请求的调用情况
+typedef boost::shared_future<CosResult> AsyncFuture;
+
 class CosAPI {
 public:
     /// \brief CosAPI构造函数
@@ -333,6 +338,15 @@ public:
     CosResult MultiUploadObject(const MultiUploadObjectReq& request,
                                 MultiUploadObjectResp* response);
 
+    /// \brief 从长度未知的流(如管道)分块上传, 数据不超过一个分块时直接PutObject
+    ///
+    /// \param request   MultiUploadObjectByStream请求
+    /// \param response  MultiUploadObject返回
+    ///
+    /// \return 返回HTTP请求的状态码及错误信息
+    CosResult MultiUploadObject(const MultiUploadObjectByStreamReq& request,
+                                MultiUploadObjectResp* response);
+
     /// \brief 舍弃一个分块上传并删除已上传的块
     ///        详见: https://www.qcloud.com/document/product/436/7740
     ///
@@ -549,16 +563,97 @@ public:
     CosResult DeleteBucketInventory(const DeleteBucketInventoryReq& request,
                                     DeleteBucketInventoryResp* response);																
 									
+    /// \brief 以下为异步接口, 请求在全局的异步线程池中执行(线程数见AsynThreadPoolSize),
+    ///        排队和执行中的任务数超过AsynTaskQueueSize时, 提交任务的线程会阻塞等待.
+    ///        request会被拷贝, 但response以及request引用的stream需要在请求完成前保持有效;
+    ///        请求完成后先填充response, 再调用callback, 最后使future就绪.
+    ///        callback中不要再同步等待其他异步任务, 否则可能占满线程池导致死锁.
+    ///        开启IsUseAsyncHttpEngine时, HeadObjectAsync和DeleteObjectsAsync直接由异步http引擎
+    ///        发送, 不占用异步线程池, callback在I/O线程中执行, 其中不要执行耗时操作或调用同步接口.
+    ///        CosAPI析构时会等待本对象提交的所有异步任务完成
+    ///
+    /// \param request  请求
+    /// \param response 返回
+    /// \param callback 完成回调, 可为空
+    ///
+    /// \return 本次请求的future
+    AsyncFuture PutObjectAsync(const PutObjectByFileReq& request,
+                               PutObjectByFileResp* response,
+                               const AsyncCallback& callback = AsyncCallback());
+
+    AsyncFuture PutObjectAsync(const PutObjectByStreamReq& request,
+                               PutObjectByStreamResp* response,
+                               const AsyncCallback& callback = AsyncCallback());
+
+    AsyncFuture GetObjectAsync(const GetObjectByFileReq& request,
+                               GetObjectByFileResp* response,
+                               const AsyncCallback& callback = AsyncCallback());
+
+    AsyncFuture GetObjectAsync(const GetObjectByStreamReq& request,
+                               GetObjectByStreamResp* response,
+                               const AsyncCallback& callback = AsyncCallback());
+
+    AsyncFuture GetObjectAsync(const MultiGetObjectReq& request,
+                               MultiGetObjectResp* response,
+                               const AsyncCallback& callback = AsyncCallback());
+
+    AsyncFuture MultiUploadObjectAsync(const MultiUploadObjectReq& request,
+                                       MultiUploadObjectResp* response,
+                                       const AsyncCallback& callback = AsyncCallback());
+
+    AsyncFuture MultiUploadObjectAsync(const MultiUploadObjectByStreamReq& request,
+                                       MultiUploadObjectResp* response,
+                                       const AsyncCallback& callback = AsyncCallback());
+
+    AsyncFuture HeadObjectAsync(const HeadObjectReq& request,
+                                HeadObjectResp* response,
+                                const AsyncCallback& callback = AsyncCallback());
+
+    AsyncFuture DeleteObjectsAsync(const DeleteObjectsReq& request,
+                                   DeleteObjectsResp* response,
+                                   const AsyncCallback& callback = AsyncCallback());
+
 private:
     int CosInit();
     void CosUInit();
 
+    /// \brief 把同步接口func包装成任务提交到异步线程池, 队列满时阻塞
+    template <class Req, class Resp>
+    AsyncFuture ScheduleAsync(CosResult (CosAPI::*func)(const Req&, Resp*),
+                              const Req& request, Resp* response,
+                              const AsyncCallback& callback);
+
+    /// \brief 在异步线程池中执行的任务体
+    template <class Req, class Resp>
+    void RunAsync(CosResult (CosAPI::*func)(const Req&, Resp*),
+                  const Req& request, Resp* response,
+                  const AsyncCallback& callback,
+                  boost::shared_ptr<boost::promise<CosResult> > promise);
+
+    /// \brief 通过异步http引擎发送请求, 请求完成后在I/O线程中收尾, 队列满时阻塞
+    template <class Req, class Resp>
+    AsyncFuture SendAsync(void (ObjectOp::*func)(const Req&, Resp*, const AsyncCallback&),
+                          const Req& request, Resp* response,
+                          const AsyncCallback& callback);
+
+    /// \brief 等待异步任务数低于AsynTaskQueueSize并计入本次任务
+    void BeginAsyncTask();
+
+    /// \brief 异步任务完成: 调用callback, 使future就绪, 最后减少任务计数
+    void FinishAsyncTask(const AsyncCallback& callback,
+                         boost::shared_ptr<boost::promise<CosResult> > promise,
+                         const CosResult& result);
+
+    /// \brief 等待本对象提交的异步任务全部完成
+    void WaitAsyncTasks();
+
 private:
     // Be careful with the m_config order
     Poco::SharedPtr<CosConfig> m_config;
     ObjectOp m_object_op; // 内部封装object相关的操作
     BucketOp m_bucket_op; // 内部封装bucket相关的操作
     ServiceOp m_service_op; // 内部封装service相关的操作
+    int m_async_task_num; // 本对象提交且未完成的异步任务数
 
     static SimpleMutex s_init_mutex;
     static bool s_init;
@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 #include <string>
+#include "cos_defines.h"
 #include "util/simple_mutex.h"
 
 namespace qcloud_cos{
@@ -120,6 +121,18 @@ public:
 
     /// \berief 设置自定义ip和端口号
     void SetIntranetAddr(const std::string& intranet_addr);
+
+    /// \brief 设置https请求的证书校验模式
+    void SetSslVerifyMode(SSL_VERIFY_MODE mode);
+
+    /// \brief 设置https请求可用的加密套件
+    void SetSslCipherList(const std::string& cipher_list);
+
+    /// \brief 设置CA证书路径
+    void SetSslCaLocation(const std::string& ca_location);
+
+    /// \brief 设置TLS会话持久化文件, 进程重启后可复用已有的TLS会话
+    void SetTlsSessionCacheFile(const std::string& file_path);
    
 private:
     mutable SimpleRWLock m_lock;
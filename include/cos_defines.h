@@ -32,10 +32,41 @@ const int kMaxThreadPoolSizeUploadPart = 100;
 /// 分块上传的线程池最小数目
 const int kMinThreadPoolSizeUploadPart = 1;
 
+/// 分块传输线程池自动计算线程数时, 每个CPU核对应的线程数
+const unsigned kTransferThreadNumPerCpu = 4;
+/// 分块传输线程池中已提交未完成的任务数默认上限
+const unsigned kDefaultMaxInflightTransferTasks = 1024;
+
+/// 断点续传下载时每完成多少个分片落盘并更新一次checkpoint
+const size_t kDownloadCheckpointFlushSliceNum = 16;
+/// 断点续传下载时checkpoint两次落盘的最长间隔, 单位ms
+const uint64_t kDownloadCheckpointFlushIntervalInms = 1000;
+
+/// 同时计算分块的md5和crc64时每次处理的数据量, 保证第二次读取时数据仍在L2缓存中
+const size_t kHashSliceSize = 256 * 1024;
+
+/// 签名时缓存SignKey的最大secret_key数
+const size_t kMaxSignKeyCacheSize = 64;
+
+/// 异步接口任务队列的默认长度
+const int kDefaultAsynTaskQueueSize = 1000;
+/// 异步接口任务队列的最小长度
+const int kMinAsynTaskQueueSize = 1;
+
+/// 每个host默认的最大连接数
+const int kDefaultMaxConnectionsPerHost = 32;
+
+/// 分块buffer池默认的内存上限1G
+const uint64_t kDefaultBufferPoolMaxSize = (uint64_t)1024 * 1024 * 1024;
+/// 分块buffer池按1M对齐分类缓存buffer
+const uint64_t kBufferPoolClassUnit = 1 * 1024 * 1024;
+
 /// 分块大小1M
 const uint64_t kPartSize1M = 1 * 1024 * 1024;
 /// 分块大小5G
 const uint64_t kPartSize5G = (uint64_t)5 * 1024 * 1024 * 1024;
+/// 单个分块上传最多的分块数, 对象大小上限为分块大小 * kMaxPartNum
+const uint64_t kMaxPartNum = 10000;
 
 typedef enum log_out_type {
     COS_LOG_NULL = 0,
@@ -52,6 +83,24 @@ typedef enum {
     HTTP_OPTIONS
 } HTTP_METHOD;
 
+typedef enum ssl_verify_mode {
+    COS_SSL_VERIFY_NONE = 0,    // 不校验服务端证书
+    COS_SSL_VERIFY_RELAXED,     // 校验服务端证书, 证书不合法时握手失败
+    COS_SSL_VERIFY_STRICT       // 严格校验, 服务端必须提供证书
+} SSL_VERIFY_MODE;
+
+typedef enum md5_mismatch_policy {
+    COS_MD5_MISMATCH_KEEP = 0,      // 保留本地文件, 由调用方根据返回结果处理
+    COS_MD5_MISMATCH_DELETE,        // 删除本地文件
+    COS_MD5_MISMATCH_MARK_PARTIAL   // 将本地文件重命名为"<文件名>.partial"
+} MD5_MISMATCH_POLICY;
+
+/// 下载失败时标记不完整文件所用的后缀
+const char* const kPartialFileSuffix = ".partial";
+
+/// HttpSender下载时返回的状态码, 表示body的MD5与ETag不一致(-1表示其他请求失败)
+const int kHttpCodeMd5Mismatch = -2;
+
 typedef enum cos_log_level {
     COS_LOG_ERR  = 1,          // LOG_ERR
     COS_LOG_WARN = 2,          // LOG_WARNING
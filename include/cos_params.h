@@ -7,6 +7,8 @@ namespace qcloud_cos{
 
 /// http header中的Authorization字段
 const std::string kHttpHeaderAuthorization = "Authorization";
+/// 对象内容的CRC64(ECMA-182), 十进制字符串
+const std::string kHttpHeaderXCosHashCrc64Ecma = "x-cos-hash-crc64ecma";
 
 const std::string kParaCustomHeaders = "custom_headers";
 const std::string kParaCacheControl = "Cache-Control";
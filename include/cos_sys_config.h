@@ -30,6 +30,17 @@ public:
     /// \brief 设置异步上传下载线程池大小,默认: 2
     static void SetAsynThreadPoolSize(unsigned size);
 
+    /// \brief 设置异步接口的任务队列长度(包括正在执行的任务),队列满时提交任务会阻塞,默认: 1000
+    static void SetAsynTaskQueueSize(unsigned size);
+
+    /// \brief 设置所有分块上传/下载/复制共享的线程池大小, 0表示按CPU核数计算, 默认: 0
+    ///        需要在第一个CosAPI对象创建前设置
+    static void SetTransferThreadPoolSize(unsigned size);
+
+    /// \brief 设置共享线程池中已提交未完成的分块任务数上限, 达到上限时提交阻塞,
+    ///        0表示不限制, 默认: 1024
+    static void SetMaxInflightTransferTasks(unsigned num);
+
     /// \brief 设置log输出,1:屏幕,2:syslog,3:不输出,默认:1
     static void SetLogOutType(LOG_OUT_TYPE log);
 
@@ -53,6 +64,65 @@ public:
 
     static void SetDestDomain(const std::string& dest_domain);
 
+    /// \brief 设置是否复用HTTP连接(连接池),默认:开启
+    static void SetUseConnectionPool(bool use_connection_pool);
+
+    /// \brief 设置每个host的最大连接数(包括使用中和空闲的连接),
+    ///        达到上限时新请求等待其他请求归还连接, 等待时间不超过连接超时时间;
+    ///        异步http引擎中只限制每个I/O线程保留的空闲连接数. 为0时不限制
+    static void SetMaxConnectionsPerHost(unsigned max_connections);
+
+    /// \brief 设置连接池中空闲连接的最长保留时间,单位:毫秒
+    static void SetConnectionIdleTimeoutInms(uint64_t time);
+
+    /// \brief 设置https请求的证书校验模式,默认:COS_SSL_VERIFY_RELAXED
+    static void SetSslVerifyMode(SSL_VERIFY_MODE mode);
+
+    /// \brief 设置https请求可用的加密套件(OpenSSL cipher list格式)
+    static void SetSslCipherList(const std::string& cipher_list);
+
+    /// \brief 设置CA证书路径(文件或目录),为空时使用系统默认CA
+    static void SetSslCaLocation(const std::string& ca_location);
+
+    /// \brief 设置是否缓存TLS会话用于会话复用,默认:开启
+    static void SetUseTlsSessionCache(bool use_tls_session_cache);
+
+    /// \brief 设置TLS会话持久化文件,为空时只在内存中缓存
+    static void SetTlsSessionCacheFile(const std::string& file_path);
+
+    /// \brief 设置是否开启TCP_NODELAY,默认:开启
+    static void SetTcpNoDelay(bool tcp_no_delay);
+
+    /// \brief 设置socket发送缓冲区大小,单位:字节,0表示使用系统默认值
+    static void SetSocketSendBufferSize(int size);
+
+    /// \brief 设置socket接收缓冲区大小,单位:字节,0表示使用系统默认值
+    static void SetSocketRecvBufferSize(int size);
+
+    /// \brief 设置TCP_NOTSENT_LOWAT,单位:字节,0表示不设置
+    static void SetTcpNotSentLowat(int size);
+
+    /// \brief 设置是否缓存域名解析结果,默认:开启
+    static void SetUseDnsCache(bool use_dns_cache);
+
+    /// \brief 设置域名解析结果的缓存时间,单位:毫秒
+    static void SetDnsCacheTtlInms(uint64_t time);
+
+    /// \brief 设置域名解析失败结果的缓存时间,单位:毫秒
+    static void SetDnsNegativeCacheTtlInms(uint64_t time);
+
+    /// \brief 设置普通请求是否使用基于epoll的异步http引擎发送,默认:关闭
+    static void SetUseAsyncHttpEngine(bool use_async_http_engine);
+
+    /// \brief 设置异步http引擎的I/O线程数,默认: 2
+    static void SetAsyncHttpIoThreadNum(unsigned thread_num);
+
+    /// \brief 设置分块buffer池的内存上限(所有传输共享),单位:字节,默认: 1G
+    static void SetBufferPoolMaxSize(uint64_t max_size);
+
+    /// \brief 设置分块buffer是否使用透明大页,默认:关闭
+    static void SetBufferPoolUseHugePage(bool use_huge_page);
+
     /// \brief 获取签名超时时间,单位秒
     static uint64_t GetAuthExpiredTime();
 
@@ -74,6 +144,15 @@ public:
     /// \brief 获取异步线程池大小
     static unsigned GetAsynThreadPoolSize();
 
+    /// \brief 获取异步接口的任务队列长度
+    static unsigned GetAsynTaskQueueSize();
+
+    /// \brief 获取共享分块传输线程池的大小, 0表示按CPU核数计算
+    static unsigned GetTransferThreadPoolSize();
+
+    /// \brief 获取共享线程池中已提交未完成的分块任务数上限
+    static unsigned GetMaxInflightTransferTasks();
+
     /// \brief 获取日志输出类型,默认输出到屏幕
     static int GetLogOutType();
 
@@ -100,6 +179,19 @@ public:
     /// \brief 设置下载过程中检查MD5
     static void SetCheckMd5(bool is_check_md5);
 
+    /// \brief 设置分块上传/多线程下载时是否用x-cos-hash-crc64ecma校验数据,默认:开启
+    static void SetCheckCrc64(bool is_check_crc64);
+
+    /// \brief 分块上传/多线程下载时是否校验CRC64
+    static bool IsCheckCrc64();
+
+    /// \brief 设置下载到本地文件时MD5校验失败的本地文件处理方式,默认:保留;
+    ///        404、网络错误等其他失败不处理本地文件
+    static void SetMd5MismatchPolicy(MD5_MISMATCH_POLICY policy);
+
+    /// \brief 获取下载到本地文件时MD5校验失败的本地文件处理方式
+    static MD5_MISMATCH_POLICY GetMd5MismatchPolicy();
+
     static bool IsDomainSameToHost();
 
     static void SetDomainSameToHost(bool is_domain_same_to_host);
@@ -120,6 +212,63 @@ public:
     /// \brief 获取特定ip和端口号
     static std::string GetIntranetAddr();   
 
+    /// \brief 是否复用HTTP连接
+    static bool IsUseConnectionPool();
+
+    /// \brief 获取每个host的最大连接数
+    static unsigned GetMaxConnectionsPerHost();
+
+    /// \brief 获取连接池中空闲连接的最长保留时间,单位:毫秒
+    static uint64_t GetConnectionIdleTimeoutInms();
+
+    /// \brief 获取https请求的证书校验模式
+    static SSL_VERIFY_MODE GetSslVerifyMode();
+
+    /// \brief 获取https请求可用的加密套件
+    static std::string GetSslCipherList();
+
+    /// \brief 获取CA证书路径
+    static std::string GetSslCaLocation();
+
+    /// \brief 是否缓存TLS会话
+    static bool IsUseTlsSessionCache();
+
+    /// \brief 获取TLS会话持久化文件
+    static std::string GetTlsSessionCacheFile();
+
+    /// \brief 是否开启TCP_NODELAY
+    static bool IsTcpNoDelay();
+
+    /// \brief 获取socket发送缓冲区大小
+    static int GetSocketSendBufferSize();
+
+    /// \brief 获取socket接收缓冲区大小
+    static int GetSocketRecvBufferSize();
+
+    /// \brief 获取TCP_NOTSENT_LOWAT
+    static int GetTcpNotSentLowat();
+
+    /// \brief 是否缓存域名解析结果
+    static bool IsUseDnsCache();
+
+    /// \brief 获取域名解析结果的缓存时间,单位:毫秒
+    static uint64_t GetDnsCacheTtlInms();
+
+    /// \brief 获取域名解析失败结果的缓存时间,单位:毫秒
+    static uint64_t GetDnsNegativeCacheTtlInms();
+
+    /// \brief 普通请求是否使用异步http引擎发送
+    static bool IsUseAsyncHttpEngine();
+
+    /// \brief 获取异步http引擎的I/O线程数
+    static unsigned GetAsyncHttpIoThreadNum();
+
+    /// \brief 获取分块buffer池的内存上限,单位:字节
+    static uint64_t GetBufferPoolMaxSize();
+
+    /// \brief 分块buffer是否使用透明大页
+    static bool IsBufferPoolUseHugePage();
+
 private:
     // 打印日志:0,不打印,1:打印到屏幕,2:打印到syslog
     static LOG_OUT_TYPE m_log_outtype;
@@ -139,6 +288,12 @@ private:
     static unsigned m_threadpool_size;
     // 异步上传下载线程池大小(全局就一个)
     static unsigned m_asyn_threadpool_size;
+    // 共享分块传输线程池的大小
+    static unsigned m_transfer_threadpool_size;
+    // 共享线程池中已提交未完成的分块任务数上限
+    static unsigned m_max_inflight_transfer_tasks;
+    // 异步接口的任务队列长度(全局就一个)
+    static unsigned m_asyn_task_queue_size;
     // 下载文件到本地线程池大小
     static unsigned m_down_thread_pool_max_size;
     // 下载文件到本地,每次下载字节数
@@ -151,6 +306,10 @@ private:
     static int64_t m_keep_intvl;
     // 下载时是否检查md5
     static bool m_is_check_md5;
+    // 分块上传/多线程下载时是否校验CRC64
+    static bool m_is_check_crc64;
+    // 下载到本地文件时MD5校验失败的本地文件处理方式
+    static MD5_MISMATCH_POLICY m_md5_mismatch_policy;
     
     static std::string m_dest_domain;
 
@@ -160,6 +319,50 @@ private:
 
     static std::string m_intranet_addr;
 
+    // 是否复用HTTP连接
+    static bool m_use_connection_pool;
+    // 每个host的最大连接数(包括使用中和空闲的连接), 0表示不限制
+    static unsigned m_max_connections_per_host;
+    // 空闲连接的最长保留时间(毫秒)
+    static uint64_t m_connection_idle_timeout_in_ms;
+
+    // https证书校验模式
+    static SSL_VERIFY_MODE m_ssl_verify_mode;
+    // https加密套件
+    static std::string m_ssl_cipher_list;
+    // CA证书路径
+    static std::string m_ssl_ca_location;
+    // 是否缓存TLS会话
+    static bool m_use_tls_session_cache;
+    // TLS会话持久化文件
+    static std::string m_tls_session_cache_file;
+
+    // 是否开启TCP_NODELAY
+    static bool m_tcp_no_delay;
+    // socket发送缓冲区大小(字节)
+    static int m_socket_send_buffer_size;
+    // socket接收缓冲区大小(字节)
+    static int m_socket_recv_buffer_size;
+    // TCP_NOTSENT_LOWAT(字节)
+    static int m_tcp_not_sent_lowat;
+
+    // 是否缓存域名解析结果
+    static bool m_use_dns_cache;
+    // 域名解析结果缓存时间(毫秒)
+    static uint64_t m_dns_cache_ttl_in_ms;
+    // 域名解析失败结果缓存时间(毫秒)
+    static uint64_t m_dns_negative_cache_ttl_in_ms;
+
+    // 普通请求是否使用异步http引擎
+    static bool m_use_async_http_engine;
+    // 异步http引擎的I/O线程数
+    static unsigned m_async_http_io_thread_num;
+
+    // 分块buffer池的内存上限(字节)
+    static uint64_t m_buffer_pool_max_size;
+    // 分块buffer是否使用透明大页
+    static bool m_buffer_pool_use_huge_page;
+
 };
 
 } // namespace qcloud_cos
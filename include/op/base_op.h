@@ -6,6 +6,7 @@
 #include <map>
 #include <string>
 
+#include "boost/function.hpp"
 #include "cos_config.h"
 #include "op/cos_result.h"
 #include "Poco/SharedPtr.h"
@@ -14,6 +15,10 @@ namespace qcloud_cos{
 
 class BaseReq;
 class BaseResp;
+struct AsyncHttpResult;
+
+/// \brief 异步接口的完成回调
+typedef boost::function<void (const CosResult& result)> AsyncCallback;
 
 class BaseOp {
 public:
@@ -79,6 +84,22 @@ public:
                            bool check_body,
                            BaseResp* resp);
 
+    /// \brief NormalAction的异步版本, 通过异步http引擎发送请求, 不占用调用线程.
+    ///        签名和请求序列化在调用线程中完成, req和req_body在返回后即可释放;
+    ///        resp需要在callback被调用前保持有效. 解析返回和callback都在I/O线程中执行,
+    ///        callback中不要执行耗时操作, 也不要调用同步接口等待异步http引擎上的请求
+    ///
+    /// \param callback 请求完成(包括失败)后的回调
+    void NormalActionAsync(const std::string& host,
+                           const std::string& path,
+                           const BaseReq& req,
+                           const std::map<std::string, std::string>& additional_headers,
+                           const std::map<std::string, std::string>& additional_params,
+                           const std::string& req_body,
+                           bool check_body,
+                           BaseResp* resp,
+                           const AsyncCallback& callback);
+
     /// \brief 下载文件并输出到流中
     ///
     /// \param host     目标主机, 以http://开头
@@ -86,13 +107,15 @@ public:
     /// \param req      http请求
     /// \param resp     http返回
     /// \param os       输出流
+    /// \param is_md5_mismatch 不为NULL时返回失败是否由MD5校验不一致导致
     ///
     /// \return http调用情况(状态码等)
     CosResult DownloadAction(const std::string& host,
                              const std::string& path,
                              const BaseReq& req,
                              BaseResp* resp,
-                             std::ostream& os);
+                             std::ostream& os,
+                             bool* is_md5_mismatch = NULL);
 
     /// \brief 支持从stream中读入数据并上传
     ///
@@ -118,6 +141,28 @@ public:
                            bool is_https);
 
 
+private:
+    /// \brief 填充请求头和参数, 并计算签名
+    bool BuildRequest(const std::string& host,
+                      const BaseReq& req,
+                      const std::map<std::string, std::string>& additional_headers,
+                      const std::map<std::string, std::string>& additional_params,
+                      std::map<std::string, std::string>* req_headers,
+                      std::map<std::string, std::string>* req_params,
+                      CosResult* result);
+
+    /// \brief 根据http状态码和返回内容生成调用结果, http_code为-1表示请求失败
+    static CosResult ParseNormalResponse(int http_code,
+                                         const std::map<std::string, std::string>& resp_headers,
+                                         const std::string& resp_body,
+                                         const std::string& err_msg,
+                                         bool check_body,
+                                         BaseResp* resp);
+
+    static void OnNormalActionDone(bool check_body, BaseResp* resp,
+                                   const AsyncCallback& callback,
+                                   const AsyncHttpResult& http_result);
+
 protected:
     Poco::SharedPtr<CosConfig> m_config;
 };
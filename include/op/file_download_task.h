@@ -11,7 +11,9 @@
 
 #include <pthread.h>
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "cos_config.h"
 #include "cos_defines.h"
@@ -19,12 +21,62 @@
 #include "cos_sys_config.h"
 #include "op/base_op.h"
 #include "util/codec_util.h"
+#include "util/download_checkpoint.h"
 #include "util/file_util.h"
 #include "util/http_sender.h"
+#include "util/simple_mutex.h"
 #include "util/string_util.h"
 
 namespace qcloud_cos {
 
+/// \brief 多线程下载时各FileDownTask共享的分片队列, 按偏移顺序分配待下载的分片
+class FileDownSliceQueue {
+public:
+    /// \brief checkpoint不为NULL时跳过其中已下载的分片并沿用其记录的CRC64,
+    ///        并定期把已写入fd的分片落盘后连同CRC64记录到checkpoint_file
+    FileDownSliceQueue(uint64_t file_size, uint64_t slice_size, int fd = -1,
+                       DownloadCheckpoint* checkpoint = NULL,
+                       const std::string& checkpoint_file = "");
+
+    /// \brief 取出下一个分片, 分片已分配完或下载已终止时返回false
+    bool Next(uint64_t* offset, size_t* len);
+
+    /// \brief 分片已写入文件, crc64为分片数据的CRC64.
+    ///        累计kDownloadCheckpointFlushSliceNum个分片或距上次落盘超过
+    ///        kDownloadCheckpointFlushIntervalInms时触发一次Flush
+    void Done(uint64_t offset, uint64_t crc64);
+
+    /// \brief fdatasync已写入的分片后再把它们记录到checkpoint文件,
+    ///        保证checkpoint中标记完成的分片在掉电后仍然有效.
+    ///        已有其他线程在落盘时直接返回, 未落盘的分片留到下一次
+    void Flush();
+
+    /// \brief 按偏移顺序合并各分片的CRC64得到整个文件的CRC64,
+    ///        有分片尚未下载时返回false
+    bool GetCrc64(uint64_t* crc64);
+
+    /// \brief 终止下载, 之后不再分配新的分片
+    void Stop();
+
+    bool IsStopped();
+
+private:
+    SimpleMutex m_mutex;
+    uint64_t m_file_size;
+    uint64_t m_slice_size;
+    uint64_t m_next_offset;
+    bool m_is_stopped;
+    int m_fd;
+    DownloadCheckpoint* m_checkpoint;
+    std::string m_checkpoint_file;
+    // 已写入fd但尚未落盘记录到checkpoint的分片序号
+    std::vector<uint64_t> m_pending_slices;
+    bool m_is_flushing;
+    uint64_t m_last_flush_in_ms;
+    // offset -> 分片的CRC64
+    std::map<uint64_t, uint64_t> m_slice_crc64s;
+};
+
 class FileDownTask {
 public:
     FileDownTask(const std::string& full_url,
@@ -40,8 +92,13 @@ public:
 
     void Run();
 
+    /// \brief 循环从slice_queue中取分片下载, 返回的数据直接pwrite到fd的对应偏移,
+    ///        单个分片失败时重试, 重试后仍失败则终止整个队列
+    void Run(FileDownSliceQueue* slice_queue, int fd);
+
     void DownTask();
 
+    /// \brief 下载的数据直接写入pdatabuf
     void SetDownParams(unsigned char* pdatabuf, size_t datalen, uint64_t offset);
 
     std::string GetTaskResp();
@@ -71,6 +128,10 @@ private:
     int m_http_status;
     std::map<std::string, std::string> m_resp_headers;
     std::string m_err_msg;
+    // 不小于0时下载的数据直接写入该文件
+    int m_fd;
+    // 开启CRC64校验时为下载数据的CRC64
+    uint64_t m_crc64;
 };
 
 } // namespace qcloud_cos
@@ -56,6 +56,9 @@ public:
 
     std::string GetErrMsg() const { return m_err_msg; }
 
+    /// \brief 上传数据的CRC64, 用于合并校验整个对象
+    uint64_t GetCrc64() const { return m_crc64; }
+
 private:
     std::string m_full_url;
     std::map<std::string, std::string> m_headers;
@@ -69,6 +72,7 @@ private:
     int m_http_status;
     std::map<std::string, std::string> m_resp_headers;
     std::string m_err_msg;
+    uint64_t m_crc64;
 };
 
 }
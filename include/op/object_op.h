@@ -14,6 +14,7 @@
 #include "op/cos_result.h"
 #include "request/object_req.h"
 #include "response/object_resp.h"
+#include "util/upload_checkpoint.h"
 
 namespace qcloud_cos {
 
@@ -43,6 +44,10 @@ public:
     /// \return 返回HTTP请求的状态码及错误信息
     CosResult HeadObject(const HeadObjectReq& req, HeadObjectResp* resp);
 
+    /// \brief HeadObject的异步版本, 通过异步http引擎发送, 在I/O线程中调用callback
+    void HeadObjectAsync(const HeadObjectReq& req, HeadObjectResp* resp,
+                         const AsyncCallback& callback);
+
     /// \brief 下载Bucket中的一个文件至流中
     ///
     /// \param request   GetObjectByStream请求
@@ -99,6 +104,10 @@ public:
     /// \return 本次请求的调用情况(如状态码等)
     CosResult DeleteObjects(const DeleteObjectsReq& req, DeleteObjectsResp* resp);
 
+    /// \brief DeleteObjects的异步版本, 通过异步http引擎发送, 在I/O线程中调用callback
+    void DeleteObjectsAsync(const DeleteObjectsReq& req, DeleteObjectsResp* resp,
+                            const AsyncCallback& callback);
+
     /// \brief 请求实现初始化分片上传,成功执行此请求以后会返回UploadId用于后续的Upload Part请求
     ///
     /// \param request   InitMultiUpload请求
@@ -142,6 +151,16 @@ public:
     /// \return 返回HTTP请求的状态码及错误信息
     CosResult MultiUploadObject(const MultiUploadObjectReq& req, MultiUploadObjectResp* resp);
 
+    /// \brief 从流中分块上传, 读满第一个分块后才初始化分块上传,
+    ///        数据不超过一个分块时直接PutObject
+    ///
+    /// \param request   MultiUploadObjectByStream请求
+    /// \param response  MultiUploadObject返回
+    ///
+    /// \return 返回HTTP请求的状态码及错误信息
+    CosResult MultiUploadObject(const MultiUploadObjectByStreamReq& req,
+                                MultiUploadObjectResp* resp);
+
     /// \brief 舍弃一个分块上传并删除已上传的块
     ///
     /// \param req  AbortMultiUpload请求
@@ -221,11 +240,20 @@ private:
     // 下载文件, 内部使用多线程
     CosResult MultiThreadDownload(const MultiGetObjectReq& req, MultiGetObjectResp* resp);
 
-    // 上传文件, 内部使用多线程
+    // 上传文件, 内部使用多线程; checkpoint不为NULL时跳过其中已上传的分块,
+    // 并把新上传成功的分块实时写入checkpoint文件.
+    // crc64_ptr返回各分块CRC64合并后的整个文件的CRC64, 无法合并时为空串
     CosResult MultiThreadUpload(const MultiUploadObjectReq& req,
                                 const std::string& upload_id,
+                                UploadCheckpoint* checkpoint,
                                 std::vector<std::string>* etags_ptr,
-                                std::vector<uint64_t>* part_numbers_ptr);
+                                std::vector<uint64_t>* part_numbers_ptr,
+                                std::string* crc64_ptr);
+
+    // 根据本地文件生成checkpoint, 并尝试从checkpoint文件恢复未完成的上传:
+    // 校验文件标识后通过ListParts核对已上传的分块. 可以续传时返回true
+    bool LoadUploadCheckpoint(const MultiUploadObjectReq& req,
+                              UploadCheckpoint* checkpoint);
 
     // 读取文件内容, 并返回读取的长度
     uint64_t GetContent(const std::string& src, std::string* file_content) const;
@@ -183,10 +183,21 @@ public:
     /// \brief 获取线程池大小
     int GetThreadPoolSize() const { return m_thread_pool_size; }
 
+    /// \brief 设置断点续传的checkpoint文件(建议放在本地文件旁, 如local_file_path + ".cpt"),
+    ///        设置后开启断点续传: 记录对象的ETag/大小/分片大小以及已下载分片的位图,
+    ///        中断后再次下载时只下载缺失的分片, 分片请求带If-Match保证对象未被修改,
+    ///        下载成功后删除checkpoint文件
+    void SetCheckpointFile(const std::string& checkpoint_file) {
+        m_checkpoint_file = checkpoint_file;
+    }
+
+    std::string GetCheckpointFile() const { return m_checkpoint_file; }
+
 private:
     std::string m_local_file_path;
     uint64_t m_slice_size;
     int m_thread_pool_size;
+    std::string m_checkpoint_file;
 };
 
 class PutObjectReq : public ObjectReq {
@@ -280,6 +291,8 @@ protected:
     virtual ~PutObjectReq() {}
 };
 
+/// \brief 从流上传对象. 流无法seek(管道、socket等)时以chunked编码边读边发,
+///        此时不发送Content-MD5, 上传完成后用边读边算的MD5校验ETag
 class PutObjectByStreamReq : public PutObjectReq {
 public:
     PutObjectByStreamReq(const std::string& bucket_name,
@@ -322,6 +335,7 @@ public:
             m_local_file_path = local_file_path;
         }
         m_need_compute_contentmd5 = true;
+        m_compute_md5_during_upload = false;
     }
 
     virtual ~PutObjectByFileReq() {}
@@ -344,9 +358,20 @@ public:
         return m_need_compute_contentmd5;
     }
 
+    /// \brief 上传过程中计算MD5, 本地文件只读一次. 开启后不再发送Content-MD5头,
+    ///        而是在上传完成后用MD5校验返回的ETag. 关闭Content-MD5时总是使用该方式
+    void SetComputeMd5DuringUpload(bool compute_md5_during_upload) {
+        m_compute_md5_during_upload = compute_md5_during_upload;
+    }
+
+    bool IsComputeMd5DuringUpload() const {
+        return m_compute_md5_during_upload || !m_need_compute_contentmd5;
+    }
+
 private:
     std::string m_local_file_path;
     bool m_need_compute_contentmd5;
+    bool m_compute_md5_during_upload;
 };
 
 class DeleteObjectReq : public ObjectReq {
@@ -682,32 +707,21 @@ private:
     std::vector<std::string> m_etags;
 };
 
-class MultiUploadObjectReq : public ObjectReq {
+/// \brief 封装了Init/UploadPart/Complete三步的分块上传请求的公共部分:
+///        分块大小、线程池大小以及Init时携带的加密方式和自定义元数据
+class MultiUploadObjectBaseReq : public ObjectReq {
 public:
-    MultiUploadObjectReq(const std::string& bucket_name,
-                   const std::string& object_name, const std::string& local_file_path = "")
+    MultiUploadObjectBaseReq(const std::string& bucket_name, const std::string& object_name)
         : ObjectReq(bucket_name, object_name) {
         // 默认使用配置文件配置的分块大小和线程池大小
         m_part_size = CosSysConfig::GetUploadPartSize();
         m_thread_pool_size = CosSysConfig::GetUploadThreadPoolSize();
         mb_set_meta = false;
-
-        // 默认打开当前路径下object的同名文件
-        if (local_file_path.empty()) {
-            m_local_file_path = "./" + object_name;
-        } else {
-            m_local_file_path = local_file_path;
-        }
     }
-    virtual ~MultiUploadObjectReq() {}
-
-    void SetLocalFilePath(const std::string& local_file_path) {
-        m_local_file_path = local_file_path;
-    }
-
-    std::string GetLocalFilePath() const { return m_local_file_path; }
+    virtual ~MultiUploadObjectBaseReq() {}
 
-    // 设置分块大小,若小于1M,则按1M计算;若大于5G,则按5G计算
+    // 设置分块大小,若小于1M,则按1M计算;若大于5G,则按5G计算.
+    // 最多kMaxPartNum个分块, 对象大小上限为分块大小 * kMaxPartNum
     void SetPartSize(uint64_t bytes) {
         if (bytes <= kPartSize1M) {
             m_part_size = kPartSize1M;
@@ -754,13 +768,76 @@ public:
     }
 
 private:
-    std::string m_local_file_path;
     uint64_t m_part_size;
     int m_thread_pool_size;
     std::map<std::string, std::string> m_xcos_meta;
     bool mb_set_meta;
 };
 
+class MultiUploadObjectReq : public MultiUploadObjectBaseReq {
+public:
+    MultiUploadObjectReq(const std::string& bucket_name,
+                   const std::string& object_name, const std::string& local_file_path = "")
+        : MultiUploadObjectBaseReq(bucket_name, object_name) {
+        m_checkpoint_verify_file_md5 = false;
+
+        // 默认打开当前路径下object的同名文件
+        if (local_file_path.empty()) {
+            m_local_file_path = "./" + object_name;
+        } else {
+            m_local_file_path = local_file_path;
+        }
+    }
+    virtual ~MultiUploadObjectReq() {}
+
+    void SetLocalFilePath(const std::string& local_file_path) {
+        m_local_file_path = local_file_path;
+    }
+
+    std::string GetLocalFilePath() const { return m_local_file_path; }
+
+    /// \brief 设置断点续传的checkpoint文件, 设置后开启断点续传:
+    ///        上传失败时不再Abort, 已上传的分块记录在checkpoint文件中,
+    ///        以相同的参数再次上传时只上传剩余的分块, 上传成功后删除checkpoint文件
+    void SetCheckpointFile(const std::string& checkpoint_file) {
+        m_checkpoint_file = checkpoint_file;
+    }
+
+    std::string GetCheckpointFile() const { return m_checkpoint_file; }
+
+    /// \brief 断点续传时是否用MD5校验本地文件未被修改(需要额外读取一遍文件),
+    ///        默认只校验文件大小和修改时间
+    void SetCheckpointVerifyFileMd5(bool is_verify) {
+        m_checkpoint_verify_file_md5 = is_verify;
+    }
+
+    bool IsCheckpointVerifyFileMd5() const { return m_checkpoint_verify_file_md5; }
+
+private:
+    std::string m_local_file_path;
+    std::string m_checkpoint_file;
+    bool m_checkpoint_verify_file_md5;
+};
+
+/// \brief 从长度未知的流(如管道)分块上传, 数据不需要先落盘, 不支持断点续传.
+///        同时最多有(线程池大小 + 1)个分块在内存中, 数据不超过一个分块时直接PutObject.
+///        流的总长度事先未知, 超过分块大小 * kMaxPartNum(例如10M的分块最多约97.6G)
+///        时上传失败并终止分块上传, 上传大对象前需要用SetPartSize调大分块
+class MultiUploadObjectByStreamReq : public MultiUploadObjectBaseReq {
+public:
+    MultiUploadObjectByStreamReq(const std::string& bucket_name,
+                                 const std::string& object_name,
+                                 std::istream& in_stream)
+        : MultiUploadObjectBaseReq(bucket_name, object_name), m_in_stream(in_stream) {}
+
+    virtual ~MultiUploadObjectByStreamReq() {}
+
+    std::istream& GetStream() const { return m_in_stream; }
+
+private:
+    std::istream& m_in_stream;
+};
+
 class AbortMultiUploadReq : public ObjectReq {
 public:
     AbortMultiUploadReq(const std::string& bucket_name,
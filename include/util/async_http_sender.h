@@ -0,0 +1,46 @@
+#ifndef ASYNC_HTTP_SENDER_H
+#define ASYNC_HTTP_SENDER_H
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include "boost/function.hpp"
+
+namespace qcloud_cos {
+
+/// \brief 异步请求的结果
+struct AsyncHttpResult {
+    AsyncHttpResult() : m_http_code(-1) {}
+
+    // http状态码, -1表示请求失败, 原因见m_err_msg
+    int m_http_code;
+    std::map<std::string, std::string> m_resp_headers;
+    std::string m_resp_body;
+    std::string m_err_msg;
+};
+
+typedef boost::function<void (const AsyncHttpResult&)> AsyncHttpCallback;
+
+/// \brief 基于epoll的非阻塞http客户端, 只提供回调接口,
+///        所有请求由少量I/O线程驱动, 并发数不再受线程数和线程栈内存的限制,
+///        适合大量小对象的GET/HEAD等请求; 请求和返回的body都保存在内存中,
+///        大文件的上传下载仍然使用HttpSender
+class AsyncHttpSender {
+public:
+    /// \brief 异步发送请求, 请求完成(包括失败和超时)后在I/O线程中调用callback,
+    ///        callback中不要执行耗时操作, 否则会阻塞同一I/O线程上的其他请求
+    static void SendRequest(const std::string& http_method,
+                            const std::string& url_str,
+                            const std::map<std::string, std::string>& req_params,
+                            const std::map<std::string, std::string>& req_headers,
+                            const std::string& req_body,
+                            uint64_t conn_timeout_in_ms,
+                            uint64_t recv_timeout_in_ms,
+                            const AsyncHttpCallback& callback);
+};
+
+} // namespace qcloud_cos
+#endif // ASYNC_HTTP_SENDER_H
@@ -15,6 +15,7 @@ namespace qcloud_cos {
 class AuthTool : private NonCopyable {
 public:
     /// \brief ǩָЧ(ͨCosSysConfig, Ĭ60s)ʹ
+    ///        q-key-timeЧڶ, ͬһڵͬһSignKey
     ///
     /// \param secret_id   ӵеĿʶ ID֤
     /// \param secret_key  ӵеĿԿ
@@ -50,28 +51,38 @@ public:
                             uint64_t start_time_in_s,
                             uint64_t end_time_in_s);
 
+    /// \brief شstart_time_in_sЧexpired_time_in_sǩ,
+    ///        q-key-timeЧڶ, ͬһڵͬһSignKey.
+    ///        ָʱSignԵǰʱCosSysConfigеЧڵñ
+    ///
+    /// \param start_time_in_s    ǩЧʱ, λ
+    /// \param expired_time_in_s  ǩЧ, λ, Ϊ0ʱq-key-timeq-sign-timeͬ
+    ///
+    /// \return ַʽǩؿմʧ
+    static std::string SignInKeyWindow(const std::string& secret_id,
+                                       const std::string& secret_key,
+                                       const std::string& http_method,
+                                       const std::string& in_uri,
+                                       const std::map<std::string, std::string>& headers,
+                                       const std::map<std::string, std::string>& params,
+                                       uint64_t start_time_in_s,
+                                       uint64_t expired_time_in_s);
+
 private:
-    /// \brief paramsеݣתСд,keyparam_list key=valueparam_value_list
-    /// \param params 
-    /// \param key_encode keyǷuri
-    /// \param value_encode valueǷuri
-    /// \param value_lower valueǷСд
-    /// \param param_list б;ָ
-    /// \param param_value_list ֵб,&ָ
-    /// \retval     
-    static void FillMap(const std::map<std::string,std::string> &params,
-                        bool key_encode,
-                        bool value_encode,
-                        bool value_lower,
-                        std::string* param_list,
-                        std::string* param_value_list);
+    /// \brief ʹƴõq-sign-timeq-key-timeǩ
+    static std::string Sign(const std::string& secret_id,
+                            const std::string& secret_key,
+                            const std::string& http_method,
+                            const std::string& in_uri,
+                            const std::map<std::string, std::string>& headers,
+                            const std::map<std::string, std::string>& params,
+                            const char* sign_time,
+                            const char* key_time);
 
-    /// \brief ҳҪȨͷ,Ŀǰhost conent-type xͷĶҪȨ
-    /// \param hedaers ͷkv
-    /// \param filted_req_headers ҪȨͷ
-    /// \retval 
-    static void FilterAndSetSignHeader(const std::map<std::string,std::string>& headers,
-                                       std::map<std::string, std::string>* filted_req_headers);
+    /// \brief secret_keykey_timeڵSignKey(40ֽСд16)дsign_key,
+    ///        ͬһڵûĽ, secret_keySHA-1Ϊkey, 
+    static void GetSignKey(const std::string& secret_key, const char* key_time,
+                           char* sign_key);
 };
 
 } // namespace qcloud_cos
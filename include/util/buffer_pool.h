@@ -0,0 +1,66 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "util/noncopyable.h"
+
+namespace qcloud_cos {
+
+/// \brief 进程内共享的分块buffer池, 线程安全.
+///        按1M对齐的大小分类缓存释放的buffer, 所有buffer(包括缓存的)总大小不超过
+///        CosSysConfig::GetBufferPoolMaxSize(), 超出时Acquire阻塞等待其他传输归还buffer
+class BufferPool : private NonCopyable {
+public:
+    static BufferPool& Instance();
+
+    /// \brief 申请至少size字节的buffer, 超出内存上限时阻塞等待.
+    ///        池中没有正在使用的buffer时即使超出上限也会分配, 保证单个传输总能进行
+    ///
+    /// \return buffer地址, 系统分配内存失败时返回NULL
+    unsigned char* Acquire(uint64_t size);
+
+    /// \brief 同Acquire, 但超出内存上限时直接返回NULL
+    unsigned char* TryAcquire(uint64_t size);
+
+    /// \brief 归还buffer, size需要与申请时一致
+    void Release(unsigned char* buf, uint64_t size);
+
+    /// \brief 释放所有缓存的空闲buffer
+    void Clear();
+
+    /// \brief 当前分配的内存总量(包括缓存的空闲buffer), 单位:字节
+    uint64_t GetTotalSize();
+
+private:
+    BufferPool() : m_total_size(0), m_in_use_size(0) {}
+    ~BufferPool() {}
+
+    static uint64_t GetClassSize(uint64_t size);
+
+    unsigned char* Acquire(uint64_t size, bool is_block);
+
+    // 释放一个空闲buffer, 没有空闲buffer时返回false. 调用方需持有m_mutex
+    bool EvictOneIdle();
+
+    static unsigned char* Allocate(uint64_t class_size);
+    static void Free(unsigned char* buf, uint64_t class_size);
+
+private:
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    // class_size -> 空闲buffer
+    std::map<uint64_t, std::vector<unsigned char*> > m_idle_buffers;
+    uint64_t m_total_size;
+    uint64_t m_in_use_size;
+};
+
+} // namespace qcloud_cos
+#endif // BUFFER_POOL_H
@@ -6,9 +6,45 @@
 #include <string>
 
 #include "json/json.h"
+#include "util/noncopyable.h"
+
+struct hmac_ctx_st;
 
 namespace qcloud_cos {
 
+/**
+ * @brief 以固定key计算hmac-sha1. 设置key时计算一次ipad/opad的摘要状态,
+ *        之后每条消息只复制该状态再追加消息, 不再重新初始化和设置key.
+ *        非线程安全, 每个线程使用自己的对象
+ */
+class HmacSha1Context : private NonCopyable {
+public:
+    HmacSha1Context();
+    ~HmacSha1Context();
+
+    /**
+     * @brief 设置key, 与当前key相同时直接复用已计算的状态
+     *
+     * @param key        秘钥
+     * @param key_len    秘钥长度
+     */
+    void SetKey(const char* key, size_t key_len);
+
+    /**
+     * @brief 计算消息的hmac-sha1, 调用前必须SetKey
+     *
+     * @param plain_text      明文
+     * @param plain_text_len  明文长度
+     * @param digest          存放结果, 至少20字节
+     */
+    void Calc(const char* plain_text, size_t plain_text_len, unsigned char* digest);
+
+private:
+    hmac_ctx_st* m_ctx;
+    std::string m_key;
+    bool m_has_key;
+};
+
 class CodecUtil {
 public:
 
@@ -47,6 +83,14 @@ public:
      */
     static std::string UrlEncode(const std::string& str);
 
+    /**
+     * @brief 对字符串进行URL编码, 结果追加到out之后, out容量足够时不分配内存
+     *
+     * @param str   带编码的字符串
+     * @param out   存放结果
+     */
+    static void UrlEncode(const std::string& str, std::string* out);
+
     /**
      * @brief 对字符串进行base64编码
      *
@@ -78,6 +122,18 @@ public:
     static std::string HmacSha1Hex(const std::string& plainText,
                                    const std::string& key);
 
+    /**
+     * @brief 获取hmacSha1的16进制值(大写), 不分配内存
+     *
+     * @param plain_text      明文
+     * @param plain_text_len  明文长度
+     * @param key             秘钥
+     * @param key_len         秘钥长度
+     * @param hex             存放结果, 至少40字节, 不以'\0'结尾
+     */
+    static void HmacSha1Hex(const char* plain_text, size_t plain_text_len,
+                            const char* key, size_t key_len, char* hex);
+
     static std::string RawMd5(const std::string& plainText);
 
     static std::string HexToBin(const std::string &strHex);
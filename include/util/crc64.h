@@ -0,0 +1,25 @@
+#ifndef CRC64_H
+#define CRC64_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "util/noncopyable.h"
+
+namespace qcloud_cos {
+
+/// \brief CRC-64/ECMA-182(即COS返回的x-cos-hash-crc64ecma), 与CRC-64/XZ相同.
+///        x86_64且CPU支持PCLMULQDQ时使用无进位乘法折叠, 否则使用slicing-by-8查表
+class Crc64 : private NonCopyable {
+public:
+    /// \brief 在crc的基础上继续计算data的CRC, 空数据的CRC为0
+    static uint64_t Calc(uint64_t crc, const void* data, size_t len);
+
+    /// \brief 已知数据A的CRC crc1、数据B的CRC crc2以及B的长度len2, 返回A+B的CRC,
+    ///        用于合并分块/分片的CRC, 不需要重新读取数据
+    static uint64_t Combine(uint64_t crc1, uint64_t crc2, uint64_t len2);
+};
+
+} // namespace qcloud_cos
+#endif // CRC64_H
@@ -0,0 +1,59 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util/noncopyable.h"
+#include "util/simple_mutex.h"
+
+namespace qcloud_cos {
+
+/// \brief 域名解析缓存, 线程安全
+///        每个host缓存全部A/AAAA记录, 新建连接时在多个ip间轮询,
+///        使并发的分块上传下载分散到不同的接入点; 解析失败的结果也会短暂缓存,
+///        避免域名异常时每个请求都阻塞在解析上
+class DnsCache : private NonCopyable {
+public:
+    static DnsCache& Instance();
+
+    /// \brief 返回host对应的一个ip, 多个ip时轮询返回
+    ///        未开启缓存或host本身是ip时原样返回
+    ///
+    /// \param host 域名
+    ///
+    /// \return ip地址, 解析失败时抛出Poco::Net::HostNotFoundException
+    std::string Resolve(const std::string& host);
+
+    /// \brief 清空缓存
+    void Clear();
+
+private:
+    struct DnsEntry {
+        std::vector<std::string> m_addrs;   // 为空表示解析失败
+        uint64_t m_expire_time_in_ms;
+        uint64_t m_next_index;
+    };
+
+    DnsCache() {}
+    ~DnsCache() {}
+
+    static uint64_t GetNowInMs();
+
+    // 调用系统解析, 失败时返回空
+    static std::vector<std::string> Lookup(const std::string& host);
+
+    // 轮询选取一个ip, 缓存的是解析失败结果时抛出异常, 调用方需持有m_mutex
+    static std::string PickAddress(const std::string& host, DnsEntry* entry);
+
+private:
+    SimpleMutex m_mutex;
+    std::map<std::string, DnsEntry> m_entries;
+};
+
+} // namespace qcloud_cos
+#endif // DNS_CACHE_H
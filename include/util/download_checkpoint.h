@@ -0,0 +1,66 @@
+#ifndef DOWNLOAD_CHECKPOINT_H
+#define DOWNLOAD_CHECKPOINT_H
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace qcloud_cos {
+
+/// \brief 多线程下载的断点信息, 以json格式保存在checkpoint文件中.
+///        记录对象的ETag、大小、分片大小、已下载分片的位图以及各分片的CRC64,
+///        用于下载中断后只下载缺失的分片, 并且续传完成后仍能校验整个对象的CRC64
+class DownloadCheckpoint {
+public:
+    DownloadCheckpoint() : m_file_size(0), m_slice_size(0) {}
+
+    /// \brief 设置下载对象的信息并清空位图
+    void Reset(const std::string& bucket_name, const std::string& object_name,
+               const std::string& etag, uint64_t file_size, uint64_t slice_size);
+
+    /// \brief 从checkpoint文件加载, 文件不存在或内容不合法时返回false
+    bool Load(const std::string& checkpoint_file);
+
+    /// \brief 写入checkpoint文件, 先写临时文件再rename, 避免中途退出导致文件损坏
+    bool Save(const std::string& checkpoint_file) const;
+
+    /// \brief 删除checkpoint文件
+    static void Remove(const std::string& checkpoint_file);
+
+    /// \brief 下载对象和分片方式是否一致, 不比较位图
+    bool IsSameDownload(const DownloadCheckpoint& other) const;
+
+    std::string GetEtag() const { return m_etag; }
+
+    uint64_t GetFileSize() const { return m_file_size; }
+
+    uint64_t GetSliceSize() const { return m_slice_size; }
+
+    /// \brief 分片是否已下载
+    bool IsSliceDone(uint64_t slice_index) const;
+
+    /// \brief 标记分片已下载, crc64为分片数据的CRC64
+    void SetSliceDone(uint64_t slice_index, uint64_t crc64);
+
+    /// \brief 已下载分片的CRC64, 分片未下载时返回0
+    uint64_t GetSliceCrc64(uint64_t slice_index) const;
+
+    /// \brief 已下载的分片数
+    uint64_t GetDoneSliceNum() const;
+
+private:
+    std::string m_bucket_name;
+    std::string m_object_name;
+    std::string m_etag;
+    uint64_t m_file_size;
+    uint64_t m_slice_size;
+    // 第i个分片是否已下载
+    std::vector<bool> m_slice_bitmap;
+    // 第i个分片的CRC64, 只对已下载的分片有效
+    std::vector<uint64_t> m_slice_crc64s;
+};
+
+} // namespace qcloud_cos
+#endif // DOWNLOAD_CHECKPOINT_H
@@ -16,6 +16,16 @@ class FileUtil
 
     //返回文件大小
     static uint64_t GetFileLen(const std::string& path);
+
+    //返回文件最后修改时间(秒), 文件不存在时返回0
+    static uint64_t GetFileMtime(const std::string& path);
+
+    //流式计算文件内容的MD5(小写hex), 文件打开失败时返回空串
+    static std::string GetFileMd5(const std::string& path);
+
+    //先写入临时文件再rename到path, 保证path要么是旧内容要么是完整的新内容;
+    //rename前fsync临时文件, rename后fsync所在目录, 掉电后同样成立
+    static bool AtomicWriteFile(const std::string& path, const std::string& content);
 };
 
 }
@@ -69,6 +69,23 @@ public:
                            std::string* err_msg,
                            bool is_check_md5 = false);
 
+    /// \brief 直接从调用方的内存发送请求body, 不经过string/istream拷贝,
+    ///        用于分块上传等大块数据; 发送过程中req_body_buf需保持有效
+    static int SendRequest(const std::string& http_method,
+                           const std::string& url_str,
+                           const std::map<std::string, std::string>& req_params,
+                           const std::map<std::string, std::string>& req_headers,
+                           const unsigned char* req_body_buf,
+                           size_t req_body_len,
+                           uint64_t conn_timeout_in_ms,
+                           uint64_t recv_timeout_in_ms,
+                           std::map<std::string, std::string>* resp_headers,
+                           std::string* resp_body,
+                           std::string* err_msg,
+                           bool is_check_md5 = false);
+
+    /// \brief 下载到resp_stream, 非2xx的body写入xml_err_str;
+    ///        body的MD5与ETag不一致时返回kHttpCodeMd5Mismatch, 其他失败返回-1
     static int SendRequest(const std::string& http_method,
                            const std::string& url_str,
                            const std::map<std::string, std::string>& req_params,
@@ -83,8 +100,81 @@ public:
                            uint64_t* real_byte,
                            bool is_check_md5 = false);
 
+    /// \brief 2xx响应的body直接读入调用方的resp_buf(最多resp_buf_len字节), 不经过string,
+    ///        带Range的请求会校验Content-Range与Content-Length, 不一致时返回-1;
+    ///        非2xx响应的body(错误信息)保存在resp_body中;
+    ///        body_crc64不为NULL时返回body的CRC64, 在读取的同时计算
+    static int SendRequest(const std::string& http_method,
+                           const std::string& url_str,
+                           const std::map<std::string, std::string>& req_params,
+                           const std::map<std::string, std::string>& req_headers,
+                           const std::string& req_body,
+                           uint64_t conn_timeout_in_ms,
+                           uint64_t recv_timeout_in_ms,
+                           std::map<std::string, std::string>* resp_headers,
+                           unsigned char* resp_buf,
+                           size_t resp_buf_len,
+                           size_t* real_len,
+                           std::string* resp_body,
+                           std::string* err_msg,
+                           uint64_t* body_crc64 = NULL);
+
+    /// \brief 同上, 2xx响应的body直接pwrite到fd的fd_offset处
+    static int SendRequest(const std::string& http_method,
+                           const std::string& url_str,
+                           const std::map<std::string, std::string>& req_params,
+                           const std::map<std::string, std::string>& req_headers,
+                           const std::string& req_body,
+                           uint64_t conn_timeout_in_ms,
+                           uint64_t recv_timeout_in_ms,
+                           std::map<std::string, std::string>* resp_headers,
+                           int fd,
+                           uint64_t fd_offset,
+                           size_t* real_len,
+                           std::string* resp_body,
+                           std::string* err_msg,
+                           uint64_t* body_crc64 = NULL);
+
+    /// \brief 拼接请求行中的path和query string, path为空时使用"/"
+    static std::string GetPathAndQuery(const std::string& path,
+                                       const std::map<std::string, std::string>& req_params);
+
     // TODO(sevenyou) 挪走
     static uint64_t GetTimeStampInUs();
+
+private:
+    // 请求body来自is(不为NULL时)或者内存req_body_buf
+    static int SendRequest(const std::string& http_method,
+                           const std::string& url_str,
+                           const std::map<std::string, std::string>& req_params,
+                           const std::map<std::string, std::string>& req_headers,
+                           std::istream* is,
+                           const unsigned char* req_body_buf,
+                           size_t req_body_len,
+                           uint64_t conn_timeout_in_ms,
+                           uint64_t recv_timeout_in_ms,
+                           std::map<std::string, std::string>* resp_headers,
+                           std::ostream& resp_stream,
+                           std::string* err_msg,
+                           bool is_check_md5);
+
+    // 2xx响应的body写入resp_buf(fd < 0时)或者pwrite到fd
+    static int SendRequest(const std::string& http_method,
+                           const std::string& url_str,
+                           const std::map<std::string, std::string>& req_params,
+                           const std::map<std::string, std::string>& req_headers,
+                           const std::string& req_body,
+                           uint64_t conn_timeout_in_ms,
+                           uint64_t recv_timeout_in_ms,
+                           std::map<std::string, std::string>* resp_headers,
+                           unsigned char* resp_buf,
+                           size_t resp_buf_len,
+                           int fd,
+                           uint64_t fd_offset,
+                           size_t* real_len,
+                           std::string* resp_body,
+                           std::string* err_msg,
+                           uint64_t* body_crc64);
 };
 
 } // namespace qcloud_cos
@@ -0,0 +1,119 @@
+#ifndef HTTP_SESSION_POOL_H
+#define HTTP_SESSION_POOL_H
+#pragma once
+
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <string>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "util/noncopyable.h"
+
+namespace Poco {
+namespace Net {
+class HTTPClientSession;
+} // namespace Net
+} // namespace Poco
+
+namespace qcloud_cos {
+
+/// \brief 按endpoint(scheme + host + port)缓存HTTP长连接, 线程安全
+///        连接使用完后归还, 下次请求同一endpoint时直接复用, 省去TCP/TLS握手;
+///        开启连接池时每个endpoint使用中和空闲的连接总数不超过MaxConnectionsPerHost
+class HttpSessionPool : private NonCopyable {
+public:
+    static HttpSessionPool& Instance();
+
+    /// \brief 获取一个连接, 优先复用健康的空闲连接, 没有则新建;
+    ///        连接数已达上限时等待其他请求归还连接
+    ///
+    /// \param is_https        是否为https连接
+    /// \param host            目标host
+    /// \param port            目标端口
+    /// \param wait_timeout_in_ms 等待连接的最长时间, 超时抛出Poco::TimeoutException
+    ///
+    /// \return 连接对象, 使用完后必须通过Release归还
+    Poco::Net::HTTPClientSession* Acquire(bool is_https, const std::string& host,
+                                          uint16_t port, uint64_t wait_timeout_in_ms);
+
+    /// \brief 归还连接, reusable为false或连接池关闭时直接关闭
+    void Release(bool is_https, const std::string& host, uint16_t port,
+                 Poco::Net::HTTPClientSession* session, bool reusable);
+
+    /// \brief 关闭所有空闲连接
+    void Clear();
+
+    /// \brief 当前缓存的空闲连接数
+    size_t GetIdleCount();
+
+    /// \brief 当前已借出未归还的连接数
+    size_t GetActiveCount();
+
+private:
+    struct IdleSession {
+        Poco::Net::HTTPClientSession* m_session;
+        uint64_t m_last_used_in_ms;
+    };
+    typedef std::list<IdleSession> IdleSessionList;
+
+    HttpSessionPool() {}
+    ~HttpSessionPool() {}
+
+    static std::string GetEndpointKey(bool is_https, const std::string& host, uint16_t port);
+
+    static Poco::Net::HTTPClientSession* CreateSession(bool is_https, const std::string& host,
+                                                       uint16_t port);
+
+    // 空闲连接上不应有可读事件, 可读说明对端已关闭或连接异常
+    static bool IsSessionHealthy(Poco::Net::HTTPClientSession* session);
+
+    static uint64_t GetNowInMs();
+
+    static void SaveTlsSession(const std::string& host, uint16_t port,
+                               Poco::Net::HTTPClientSession* session);
+
+    // 清理超过空闲时间的连接, 调用方需持有m_mutex
+    void EvictExpired(IdleSessionList* idle_list, uint64_t now_in_ms);
+
+private:
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::map<std::string, IdleSessionList> m_idle_sessions;
+    // 每个endpoint已借出的连接数
+    std::map<std::string, unsigned> m_active_counts;
+};
+
+/// \brief 在作用域内持有一个连接池中的连接, 析构时自动归还
+class HttpSessionGuard : private NonCopyable {
+public:
+    HttpSessionGuard(bool is_https, const std::string& host, uint16_t port,
+                     uint64_t wait_timeout_in_ms)
+        : m_is_https(is_https), m_host(host), m_port(port), m_reusable(false) {
+        m_session = HttpSessionPool::Instance().Acquire(is_https, host, port,
+                                                        wait_timeout_in_ms);
+    }
+
+    ~HttpSessionGuard() {
+        HttpSessionPool::Instance().Release(m_is_https, m_host, m_port, m_session, m_reusable);
+    }
+
+    Poco::Net::HTTPClientSession* operator->() const { return m_session; }
+    Poco::Net::HTTPClientSession& operator*() const { return *m_session; }
+
+    /// \brief 响应完整读取且服务端允许keep-alive时, 才可以将连接放回连接池
+    void SetReusable(bool reusable) { m_reusable = reusable; }
+
+private:
+    bool m_is_https;
+    std::string m_host;
+    uint16_t m_port;
+    bool m_reusable;
+    Poco::Net::HTTPClientSession* m_session;
+};
+
+} // namespace qcloud_cos
+#endif // HTTP_SESSION_POOL_H
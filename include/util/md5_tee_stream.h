@@ -0,0 +1,78 @@
+#ifndef MD5_TEE_STREAM_H
+#define MD5_TEE_STREAM_H
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#include "Poco/MD5Engine.h"
+
+namespace qcloud_cos {
+
+/// \brief 将写入的数据原样转发给sink, 同时对sink实际接收的数据计算摘要
+class DigestTeeStreamBuf : public std::streambuf {
+public:
+    DigestTeeStreamBuf(std::streambuf* sink, Poco::DigestEngine* engine)
+        : m_sink(sink), m_engine(engine) {}
+
+protected:
+    virtual int overflow(int c);
+    virtual std::streamsize xsputn(const char* s, std::streamsize n);
+    virtual int sync();
+
+private:
+    std::streambuf* m_sink;
+    Poco::DigestEngine* m_engine;
+};
+
+/// \brief 从source读取数据, 同时对读出的数据计算摘要.
+///        只允许在读取之前seek(如计算长度), 读取开始后的seek会失败, 保证摘要覆盖的正是读出的数据
+class DigestTeeInputStreamBuf : public std::streambuf {
+public:
+    DigestTeeInputStreamBuf(std::streambuf* source, Poco::DigestEngine* engine);
+
+protected:
+    virtual int_type underflow();
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                             std::ios_base::openmode which);
+    virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which);
+
+private:
+    static const std::streamsize kBufferSize = 64 * 1024;
+
+    std::streambuf* m_source;
+    Poco::DigestEngine* m_engine;
+    bool m_read_started;
+    char m_buffer[kBufferSize];
+};
+
+/// \brief 边写边算MD5的输出流, 下载时body只经过一次, 不需要在内存中缓存整个body
+class Md5TeeOutputStream : public std::ostream {
+public:
+    explicit Md5TeeOutputStream(std::ostream& sink);
+
+    /// \brief 返回已写入数据的MD5(小写hex), 调用后摘要状态被重置
+    std::string GetMd5();
+
+private:
+    Poco::MD5Engine m_md5;
+    DigestTeeStreamBuf m_buf;
+};
+
+/// \brief 边读边算MD5的输入流, 上传时文件只读一次, 上传完成后再用MD5校验ETag
+class Md5TeeInputStream : public std::istream {
+public:
+    explicit Md5TeeInputStream(std::istream& source);
+
+    /// \brief 返回已读出数据的MD5(小写hex), 调用后摘要状态被重置
+    std::string GetMd5();
+
+private:
+    Poco::MD5Engine m_md5;
+    DigestTeeInputStreamBuf m_buf;
+};
+
+} // namespace qcloud_cos
+#endif // MD5_TEE_STREAM_H
@@ -1,39 +1,45 @@
 #ifndef SHA_H
 #define SHA_H
-#include <stdlib.h>
-#include <stdio.h>
+
+#include <stddef.h>
 
 #include <string>
 
-namespace qcloud_cos {
+#include "util/noncopyable.h"
 
-/* Useful defines & typedefs */
-typedef unsigned char SHA_BYTE;	/* 8-bit quantity */
+struct evp_md_ctx_st;
 
-// SHA_LONG already defined in openssl/sha.h
-typedef unsigned int  SHA_LONG;	/* 32-or-more-bit quantity */
-#define SHA_BYTE_ORDER 1234
-#define SHA_VERSION 1
+namespace qcloud_cos {
 
 #define SHA_BLOCKSIZE		64
 #define SHA_DIGESTSIZE		20
 
+#if defined(__GNUC__)
+#define COS_SHA_DEPRECATED __attribute__((deprecated))
+#else
+#define COS_SHA_DEPRECATED
+#endif
+
+typedef unsigned char SHA_BYTE;	/* 8-bit quantity */
+typedef unsigned int  SHA_LONG;	/* 32-or-more-bit quantity */
+
+/// \brief 旧版SHA-1接口的状态, 已废弃, 请使用Sha1.
+///        ShaInit分配EVP上下文, ShaFinal释放, 因此ShaInit之后必须调用ShaFinal
 typedef struct {
-    SHA_LONG digest[5];		/* message digest */
-    SHA_LONG count_lo, count_hi;	/* 64-bit bit count */
-    SHA_BYTE data[SHA_BLOCKSIZE];	/* SHA data buffer */
-    int local;			/* unprocessed amount in data */
+    evp_md_ctx_st* ctx;
 } SHA_INFO;
 
+/// \brief 以下为旧版SHA-1接口, 已废弃, 转调OpenSSL EVP, 仅为兼容保留
+COS_SHA_DEPRECATED void ShaInit(SHA_INFO *);
+COS_SHA_DEPRECATED void ShaUpdate(SHA_INFO *, SHA_BYTE *, int);
+COS_SHA_DEPRECATED void ShaFinal(unsigned char [20], SHA_INFO *);
 
-void ShaInit(SHA_INFO *);
-void ShaUpdate(SHA_INFO *, SHA_BYTE *, int);
-void ShaFinal(unsigned char [20], SHA_INFO *);
+/// \brief 把20字节摘要以小写16进制写入output, 与旧实现一致在output[40]写入'\0'
+COS_SHA_DEPRECATED void ShaOutput(unsigned char [20], unsigned char [40]);
+COS_SHA_DEPRECATED const char* ShaVersion(void);
 
-void ShaOutput(unsigned char [20],unsigned char [40]);
-const char* ShaVersion(void);
-
-class Sha1 {
+/// \brief SHA-1, 通过OpenSSL EVP计算, CPU支持时使用SHA-NI/AVX2等指令加速
+class Sha1 : private NonCopyable {
 public:
     Sha1();
     ~Sha1();
@@ -41,8 +47,14 @@ public:
     void Append(const char* data, unsigned int size);
     std::string Final();
 
+    /// \brief 把16进制(小写)结果写入hex, hex至少SHA_DIGESTSIZE * 2 + 1字节, 以'\0'结尾
+    void Final(char* hex);
+
+    /// \brief 清空已输入的数据, 复用对象计算下一个摘要, 不重新分配内存
+    void Reset();
+
 private:
-    SHA_INFO    m_sha;
+    evp_md_ctx_st* m_ctx;
 };
 
 }
@@ -0,0 +1,27 @@
+#ifndef SOCKET_OPTIONS_H
+#define SOCKET_OPTIONS_H
+#pragma once
+
+#include "Poco/Net/StreamSocket.h"
+
+#include "util/noncopyable.h"
+
+namespace qcloud_cos {
+
+/// \brief 按CosSysConfig中的配置设置socket参数,
+///        包括TCP keepalive、TCP_NODELAY、收发缓冲区大小和TCP_NOTSENT_LOWAT
+class SocketOptions : private NonCopyable {
+public:
+    /// \brief 在socket创建后、connect之前调用, 收发缓冲区大小才能影响三次握手时
+    ///        协商的窗口扩大因子; 单个参数设置失败只打印日志, 不影响请求
+    static void Apply(Poco::Net::StreamSocket& socket);
+
+    /// \brief 同上, 用于非Poco管理的socket
+    static void Apply(int sockfd);
+
+private:
+    static void SetOption(int sockfd, int level, int option, int value, const char* name);
+};
+
+} // namespace qcloud_cos
+#endif // SOCKET_OPTIONS_H
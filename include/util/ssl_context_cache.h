@@ -0,0 +1,38 @@
+#ifndef SSL_CONTEXT_CACHE_H
+#define SSL_CONTEXT_CACHE_H
+#pragma once
+
+#include <string>
+
+#include "Poco/Net/Context.h"
+
+#include "util/noncopyable.h"
+#include "util/simple_mutex.h"
+
+namespace qcloud_cos {
+
+/// \brief 进程内共享的https客户端SSL Context
+///        Context的创建需要加载CA证书和解析加密套件, 开销较大,
+///        所有https连接共用一个Context, 仅在CosSysConfig中的ssl配置变化时重建
+class SslContextCache : private NonCopyable {
+public:
+    /// \brief 获取与当前ssl配置对应的客户端Context
+    static Poco::Net::Context::Ptr GetClientContext();
+
+    /// \brief 释放缓存的Context, 下次获取时重新创建
+    static void Clear();
+
+private:
+    // 由校验模式、加密套件、CA路径拼接而成, 用于判断配置是否变化
+    static std::string GetConfigKey();
+
+    static Poco::Net::Context::Ptr CreateClientContext();
+
+private:
+    static SimpleMutex m_mutex;
+    static std::string m_config_key;
+    static Poco::Net::Context::Ptr m_context;
+};
+
+} // namespace qcloud_cos
+#endif // SSL_CONTEXT_CACHE_H
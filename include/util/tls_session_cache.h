@@ -0,0 +1,133 @@
+#ifndef TLS_SESSION_CACHE_H
+#define TLS_SESSION_CACHE_H
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include <openssl/ssl.h>
+
+#include "Poco/Net/Session.h"
+
+#include "util/noncopyable.h"
+#include "util/simple_mutex.h"
+
+namespace qcloud_cos {
+
+/// \brief 持有SSL_SESSION的一个引用, 拷贝时增加引用计数, 析构时释放
+class SslSessionRef {
+public:
+    SslSessionRef() : m_ssl_session(NULL) {}
+
+    /// \brief 接管ssl_session的一个引用, 如SSL_get1_session/d2i_SSL_SESSION的返回值
+    explicit SslSessionRef(SSL_SESSION* ssl_session) : m_ssl_session(ssl_session) {}
+
+    SslSessionRef(const SslSessionRef& other) : m_ssl_session(other.m_ssl_session) {
+        AddRef(m_ssl_session);
+    }
+
+    SslSessionRef& operator=(const SslSessionRef& other) {
+        SslSessionRef tmp(other);
+        std::swap(m_ssl_session, tmp.m_ssl_session);
+        return *this;
+    }
+
+    ~SslSessionRef() {
+        if (m_ssl_session != NULL) {
+            SSL_SESSION_free(m_ssl_session);
+        }
+    }
+
+    /// \brief 增加引用计数后持有ssl_session, 用于他人持有的会话, 如Poco会话中的SSL_SESSION
+    static SslSessionRef Share(SSL_SESSION* ssl_session) {
+        AddRef(ssl_session);
+        return SslSessionRef(ssl_session);
+    }
+
+    SSL_SESSION* Get() const { return m_ssl_session; }
+
+    bool IsNull() const { return m_ssl_session == NULL; }
+
+private:
+    static void AddRef(SSL_SESSION* ssl_session) {
+        if (ssl_session != NULL) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+            SSL_SESSION_up_ref(ssl_session);
+#else
+            CRYPTO_add(&ssl_session->references, 1, CRYPTO_LOCK_SSL_SESSION);
+#endif
+        }
+    }
+
+private:
+    SSL_SESSION* m_ssl_session;
+};
+
+/// \brief 按host + port缓存TLS会话, 新建https连接时用于会话复用(session resumption),
+///        省去完整的TLS握手. 配置了TlsSessionCacheFile时会话会持久化到本地文件,
+///        进程重启后可直接复用. 线程安全
+///
+///        缓存以SSL_SESSION保存会话, 供直接使用OpenSSL的异步引擎和持久化使用.
+///        Poco的Session只能由Poco自身创建, 因此同步连接另外保存Poco握手得到的Session,
+///        通过SecureStreamSocket::useSession交还给Poco; 从文件加载或由异步引擎得到的会话
+///        同步连接无法复用, 首次同步连接仍需完整握手
+class TlsSessionCache : private NonCopyable {
+public:
+    static TlsSessionCache& Instance();
+
+    /// \brief 获取endpoint对应的TLS会话, 不存在时返回空的引用
+    SslSessionRef Get(const std::string& host, uint16_t port);
+
+    /// \brief 获取endpoint上同步连接握手得到的Poco会话, 不存在时返回空指针
+    Poco::Net::Session::Ptr GetPocoSession(const std::string& host, uint16_t port);
+
+    /// \brief 保存endpoint最近一次握手得到的TLS会话
+    void Put(const std::string& host, uint16_t port, const SslSessionRef& ssl_session);
+
+    /// \brief 保存同步连接握手得到的Poco会话, 会话须由Poco创建
+    void Put(const std::string& host, uint16_t port, Poco::Net::Session::Ptr poco_session);
+
+    /// \brief 将缓存的会话写入持久化文件, 未配置文件时不做任何操作
+    void Save();
+
+    /// \brief 持久化后清空缓存
+    void Clear();
+
+private:
+    struct SessionEntry {
+        SslSessionRef m_ssl_session;
+        Poco::Net::Session::Ptr m_poco_session;
+    };
+
+    TlsSessionCache() : m_loaded(false) {}
+    ~TlsSessionCache() {}
+
+    static std::string GetEndpointKey(const std::string& host, uint16_t port);
+
+    // 会话是否已过期
+    static bool IsExpired(SSL_SESSION* ssl_session);
+
+    // 按需加载持久化文件后查找未过期的会话, 调用方需持有m_mutex
+    SessionEntry* FindEntry(const std::string& host, uint16_t port);
+
+    // 保存会话, 新的endpoint立即落盘, 调用方需持有m_mutex
+    void PutEntry(const std::string& host, uint16_t port, const SslSessionRef& ssl_session,
+                  Poco::Net::Session::Ptr poco_session);
+
+    // 从持久化文件加载会话, 调用方需持有m_mutex
+    void LoadFromFile(const std::string& file_path);
+
+    // 将会话写入持久化文件, 调用方需持有m_mutex
+    void SaveToFile(const std::string& file_path);
+
+private:
+    SimpleMutex m_mutex;
+    bool m_loaded;
+    std::map<std::string, SessionEntry> m_sessions;
+};
+
+} // namespace qcloud_cos
+#endif // TLS_SESSION_CACHE_H
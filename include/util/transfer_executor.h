@@ -0,0 +1,101 @@
+#ifndef TRANSFER_EXECUTOR_H
+#define TRANSFER_EXECUTOR_H
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "util/noncopyable.h"
+
+namespace qcloud_cos {
+
+/// \brief 进程内共享的分块传输线程池, 线程安全.
+///        分块上传、分片下载和分块复制的任务都提交到这里, 不再每次调用创建线程.
+///        每个工作线程有自己的任务队列, 空闲时从其他线程的队列尾部窃取任务.
+///        由CosAPI在第一个实例创建时启动, 最后一个实例析构时停止
+class TransferExecutor : private NonCopyable {
+public:
+    typedef boost::function<void ()> Task;
+
+    static TransferExecutor& Instance();
+
+    /// \brief 启动工作线程, thread_num为0时按CPU核数计算, 已启动时不做任何操作
+    void Start(unsigned thread_num);
+
+    /// \brief 执行完已提交的任务后回收所有工作线程
+    void Stop();
+
+    /// \brief 提交任务, 未启动时按CosSysConfig的配置自动启动.
+    ///        已提交未完成的任务数达到CosSysConfig::GetMaxInflightTransferTasks()时阻塞等待,
+    ///        工作线程内提交的任务不受该上限限制.
+    ///        Stop执行期间, 工作线程提交的任务照常执行, 其他线程等待Stop结束后重新启动
+    void Schedule(const Task& task);
+
+    /// \brief 工作线程数, 未启动时返回0
+    unsigned GetThreadNum();
+
+private:
+    struct Worker {
+        boost::mutex m_mutex;
+        std::deque<Task> m_tasks;
+    };
+
+    TransferExecutor() : m_running(false), m_stopping(false), m_pending_num(0),
+                         m_inflight_num(0), m_next_worker(0) {}
+    ~TransferExecutor() {}
+
+    // 调用方需持有m_mutex
+    void StartLocked(unsigned thread_num);
+
+    void WorkerLoop(unsigned index);
+
+    // 优先从自己队列头部取任务, 否则从其他队列尾部窃取
+    bool PopTask(unsigned index, Task* task);
+
+private:
+    boost::mutex m_mutex;
+    // 工作线程等待新任务
+    boost::condition_variable m_task_cond;
+    // 提交方等待未完成的任务数降到上限以下
+    boost::condition_variable m_slot_cond;
+    // 提交方等待Stop回收完工作线程
+    boost::condition_variable m_stop_cond;
+    bool m_running;
+    // Stop正在回收工作线程, 此时m_workers仍然有效
+    bool m_stopping;
+    std::vector<Worker*> m_workers;
+    std::vector<boost::thread*> m_threads;
+    // 已放入队列但还没有被工作线程领取的任务数
+    unsigned m_pending_num;
+    // 已提交但还没有执行完的任务数
+    unsigned m_inflight_num;
+    unsigned m_next_worker;
+};
+
+/// \brief 一组提交到TransferExecutor的任务, 用于等待本组任务全部完成
+class TransferTaskGroup : private NonCopyable {
+public:
+    TransferTaskGroup() : m_running_num(0) {}
+    ~TransferTaskGroup() { Wait(); }
+
+    void Schedule(const TransferExecutor::Task& task);
+
+    /// \brief 等待本组已提交的任务全部执行完
+    void Wait();
+
+private:
+    void RunTask(const TransferExecutor::Task& task);
+
+private:
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    unsigned m_running_num;
+};
+
+} // namespace qcloud_cos
+#endif // TRANSFER_EXECUTOR_H
@@ -0,0 +1,83 @@
+#ifndef UPLOAD_CHECKPOINT_H
+#define UPLOAD_CHECKPOINT_H
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+namespace qcloud_cos {
+
+/// \brief 分块上传的断点信息, 以json格式保存在checkpoint文件中.
+///        记录uploadId、分块大小、本地文件的标识(大小/修改时间/可选的MD5)
+///        以及已上传成功的分块及其CRC64, 用于上传中断后只上传剩余的分块,
+///        并且续传完成后仍能校验整个对象的CRC64
+class UploadCheckpoint {
+public:
+    UploadCheckpoint() : m_part_size(0), m_file_size(0), m_file_mtime(0) {}
+
+    /// \brief 从checkpoint文件加载, 文件不存在或内容不合法时返回false
+    bool Load(const std::string& checkpoint_file);
+
+    /// \brief 写入checkpoint文件, 先写临时文件再rename, 避免中途退出导致文件损坏
+    bool Save(const std::string& checkpoint_file) const;
+
+    /// \brief 删除checkpoint文件
+    static void Remove(const std::string& checkpoint_file);
+
+    /// \brief 上传目标、分块大小以及本地文件标识是否一致, 不比较uploadId和分块
+    bool IsSameUpload(const UploadCheckpoint& other) const;
+
+    void SetUploadId(const std::string& upload_id) { m_upload_id = upload_id; }
+    std::string GetUploadId() const { return m_upload_id; }
+
+    void SetBucketName(const std::string& bucket_name) { m_bucket_name = bucket_name; }
+    std::string GetBucketName() const { return m_bucket_name; }
+
+    void SetObjectName(const std::string& object_name) { m_object_name = object_name; }
+    std::string GetObjectName() const { return m_object_name; }
+
+    void SetPartSize(uint64_t part_size) { m_part_size = part_size; }
+    uint64_t GetPartSize() const { return m_part_size; }
+
+    void SetFileSize(uint64_t file_size) { m_file_size = file_size; }
+    uint64_t GetFileSize() const { return m_file_size; }
+
+    void SetFileMtime(uint64_t file_mtime) { m_file_mtime = file_mtime; }
+    uint64_t GetFileMtime() const { return m_file_mtime; }
+
+    /// \brief 本地文件的MD5, 为空表示不校验
+    void SetFileMd5(const std::string& file_md5) { m_file_md5 = file_md5; }
+    std::string GetFileMd5() const { return m_file_md5; }
+
+    /// \brief 记录上传成功的分块, crc64为分块数据的CRC64
+    void AddPart(uint64_t part_number, const std::string& etag, uint64_t crc64) {
+        m_parts[part_number] = etag;
+        m_part_crc64s[part_number] = crc64;
+    }
+    bool HasPart(uint64_t part_number) const { return m_parts.count(part_number) > 0; }
+    void SetParts(const std::map<uint64_t, std::string>& parts,
+                  const std::map<uint64_t, uint64_t>& part_crc64s) {
+        m_parts = parts;
+        m_part_crc64s = part_crc64s;
+    }
+    const std::map<uint64_t, std::string>& GetParts() const { return m_parts; }
+    const std::map<uint64_t, uint64_t>& GetPartCrc64s() const { return m_part_crc64s; }
+
+private:
+    std::string m_upload_id;
+    std::string m_bucket_name;
+    std::string m_object_name;
+    uint64_t m_part_size;
+    uint64_t m_file_size;
+    uint64_t m_file_mtime;
+    std::string m_file_md5;
+    // part_number -> etag
+    std::map<uint64_t, std::string> m_parts;
+    // part_number -> 分块数据的CRC64
+    std::map<uint64_t, uint64_t> m_part_crc64s;
+};
+
+} // namespace qcloud_cos
+#endif // UPLOAD_CHECKPOINT_H
@@ -0,0 +1,15 @@
+#ifndef URL_ENCODE_H
+#define URL_ENCODE_H
+#pragma once
+
+#include <string>
+
+namespace qcloud_cos {
+
+/// \brief 把str的url编码结果追加到out, 字母、数字以及-_.~不编码, keep_slash时'/'也不编码.
+///        x86_64上按CPU支持情况使用AVX2/SSE2批量查找连续的不需要编码的字符,
+///        供codec_util.cpp和codec_util_high_openssl.cpp共用
+void UrlEncodeAppend(const std::string& str, bool keep_slash, std::string* out);
+
+} // namespace qcloud_cos
+#endif // URL_ENCODE_H
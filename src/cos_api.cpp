@@ -2,12 +2,20 @@
 
 #include <pthread.h>
 
+#include "boost/bind.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
 #include "threadpool/boost/threadpool.hpp"
 #include "Poco/Net/HTTPStreamFactory.h"
 #include "Poco/Net/HTTPSStreamFactory.h"
 #include "Poco/Net/SSLManager.h"
 
 #include "cos_sys_config.h"
+#include "util/buffer_pool.h"
+#include "util/http_session_pool.h"
+#include "util/ssl_context_cache.h"
+#include "util/tls_session_cache.h"
+#include "util/transfer_executor.h"
 #include "util/string_util.h"
 
 namespace qcloud_cos {
@@ -18,12 +26,20 @@ int CosAPI::s_cos_obj_num = 0;
 SimpleMutex CosAPI::s_init_mutex = SimpleMutex();
 boost::threadpool::pool* g_threadpool = NULL;
 
+// 异步接口的任务计数, 所有CosAPI对象共享g_threadpool, 因此队列长度也是全局的
+static boost::mutex s_async_mutex;
+static boost::condition_variable s_async_cond;
+static unsigned s_async_task_num = 0;
+
 CosAPI::CosAPI(CosConfig& config)
-    : m_config(new CosConfig(config)), m_object_op(m_config), m_bucket_op(m_config), m_service_op(m_config) {
+    : m_config(new CosConfig(config)), m_object_op(m_config), m_bucket_op(m_config), m_service_op(m_config),
+      m_async_task_num(0) {
     CosInit();
 }
 
 CosAPI::~CosAPI() {
+    // 异步任务持有this指针, 需要先等待其完成
+    WaitAsyncTasks();
     CosUInit();
 }
 
@@ -39,6 +55,7 @@ int CosAPI::CosInit() {
         }
 
         g_threadpool = new boost::threadpool::pool(CosSysConfig::GetAsynThreadPoolSize());
+        TransferExecutor::Instance().Start(CosSysConfig::GetTransferThreadPoolSize());
         s_init = true;
     }
 
@@ -54,11 +71,106 @@ void CosAPI::CosUInit() {
             delete g_threadpool;
             g_threadpool = NULL;
         }
+        // 异步任务中的分块传输也使用共享线程池, 需要在g_threadpool之后停止
+        TransferExecutor::Instance().Stop();
 
+        HttpSessionPool::Instance().Clear();
+        BufferPool::Instance().Clear();
+        SslContextCache::Clear();
+        TlsSessionCache::Instance().Clear();
         s_init = false;
     }
 }
 
+void CosAPI::BeginAsyncTask() {
+    boost::unique_lock<boost::mutex> lock(s_async_mutex);
+    while (s_async_task_num >= CosSysConfig::GetAsynTaskQueueSize()) {
+        s_async_cond.wait(lock);
+    }
+    ++s_async_task_num;
+    ++m_async_task_num;
+}
+
+void CosAPI::FinishAsyncTask(const AsyncCallback& callback,
+                             boost::shared_ptr<boost::promise<CosResult> > promise,
+                             const CosResult& result) {
+    if (callback) {
+        try {
+            callback(result);
+        } catch (const std::exception& e) {
+            SDK_LOG_ERR("Async callback throw exception: %s", e.what());
+        }
+    }
+
+    promise->set_value(result);
+
+    // 计数减到0后本对象可能立即被析构, 此后不能再访问成员
+    boost::unique_lock<boost::mutex> lock(s_async_mutex);
+    --s_async_task_num;
+    --m_async_task_num;
+    s_async_cond.notify_all();
+}
+
+template <class Req, class Resp>
+AsyncFuture CosAPI::ScheduleAsync(CosResult (CosAPI::*func)(const Req&, Resp*),
+                                  const Req& request, Resp* response,
+                                  const AsyncCallback& callback) {
+    boost::shared_ptr<boost::promise<CosResult> > promise(new boost::promise<CosResult>());
+    AsyncFuture future(promise->get_future());
+    BeginAsyncTask();
+
+    // request按值绑定, 调用方可以在提交后立即释放自己的request
+    g_threadpool->schedule(boost::bind(&CosAPI::RunAsync<Req, Resp>, this, func,
+                                       request, response, callback, promise));
+    return future;
+}
+
+template <class Req, class Resp>
+void CosAPI::RunAsync(CosResult (CosAPI::*func)(const Req&, Resp*),
+                      const Req& request, Resp* response,
+                      const AsyncCallback& callback,
+                      boost::shared_ptr<boost::promise<CosResult> > promise) {
+    CosResult result;
+    try {
+        result = (this->*func)(request, response);
+    } catch (const std::exception& e) {
+        SDK_LOG_ERR("Async task throw exception: %s", e.what());
+        result.SetFail();
+        result.SetErrorInfo(std::string("Async task throw exception: ") + e.what());
+    }
+
+    FinishAsyncTask(callback, promise, result);
+}
+
+template <class Req, class Resp>
+AsyncFuture CosAPI::SendAsync(void (ObjectOp::*func)(const Req&, Resp*, const AsyncCallback&),
+                              const Req& request, Resp* response,
+                              const AsyncCallback& callback) {
+    boost::shared_ptr<boost::promise<CosResult> > promise(new boost::promise<CosResult>());
+    AsyncFuture future(promise->get_future());
+    BeginAsyncTask();
+
+    // 签名和请求序列化在当前线程完成, 之后不再访问request
+    AsyncCallback done = boost::bind(&CosAPI::FinishAsyncTask, this, callback, promise, _1);
+    try {
+        (m_object_op.*func)(request, response, done);
+    } catch (const std::exception& e) {
+        SDK_LOG_ERR("Async task throw exception: %s", e.what());
+        CosResult result;
+        result.SetFail();
+        result.SetErrorInfo(std::string("Async task throw exception: ") + e.what());
+        done(result);
+    }
+    return future;
+}
+
+void CosAPI::WaitAsyncTasks() {
+    boost::unique_lock<boost::mutex> lock(s_async_mutex);
+    while (m_async_task_num > 0) {
+        s_async_cond.wait(lock);
+    }
+}
+
 void CosAPI::SetCredentail(const std::string& ak, const std::string& sk, const std::string& token){
     m_config->SetConfigCredentail(ak,sk,token);
 }
@@ -257,6 +369,11 @@ CosResult CosAPI::MultiUploadObject(const MultiUploadObjectReq& request,
     return m_object_op.MultiUploadObject(request, response);
 }
 
+CosResult CosAPI::MultiUploadObject(const MultiUploadObjectByStreamReq& request,
+                                    MultiUploadObjectResp* response) {
+    return m_object_op.MultiUploadObject(request, response);
+}
+
 CosResult CosAPI::AbortMultiUpload(const AbortMultiUploadReq& request,
                                    AbortMultiUploadResp* response) {
     return m_object_op.AbortMultiUpload(request, response);
@@ -367,5 +484,76 @@ CosResult CosAPI::DeleteBucketInventory(const DeleteBucketInventoryReq& request,
     return m_bucket_op.DeleteBucketInventory(request, response);						  
 }
 
+AsyncFuture CosAPI::PutObjectAsync(const PutObjectByFileReq& request,
+                                   PutObjectByFileResp* response,
+                                   const AsyncCallback& callback) {
+    return ScheduleAsync<PutObjectByFileReq, PutObjectByFileResp>(
+        &CosAPI::PutObject, request, response, callback);
+}
+
+AsyncFuture CosAPI::PutObjectAsync(const PutObjectByStreamReq& request,
+                                   PutObjectByStreamResp* response,
+                                   const AsyncCallback& callback) {
+    return ScheduleAsync<PutObjectByStreamReq, PutObjectByStreamResp>(
+        &CosAPI::PutObject, request, response, callback);
+}
+
+AsyncFuture CosAPI::GetObjectAsync(const GetObjectByFileReq& request,
+                                   GetObjectByFileResp* response,
+                                   const AsyncCallback& callback) {
+    return ScheduleAsync<GetObjectByFileReq, GetObjectByFileResp>(
+        &CosAPI::GetObject, request, response, callback);
+}
+
+AsyncFuture CosAPI::GetObjectAsync(const GetObjectByStreamReq& request,
+                                   GetObjectByStreamResp* response,
+                                   const AsyncCallback& callback) {
+    return ScheduleAsync<GetObjectByStreamReq, GetObjectByStreamResp>(
+        &CosAPI::GetObject, request, response, callback);
+}
+
+AsyncFuture CosAPI::GetObjectAsync(const MultiGetObjectReq& request,
+                                   MultiGetObjectResp* response,
+                                   const AsyncCallback& callback) {
+    return ScheduleAsync<MultiGetObjectReq, MultiGetObjectResp>(
+        &CosAPI::GetObject, request, response, callback);
+}
+
+AsyncFuture CosAPI::MultiUploadObjectAsync(const MultiUploadObjectReq& request,
+                                           MultiUploadObjectResp* response,
+                                           const AsyncCallback& callback) {
+    return ScheduleAsync<MultiUploadObjectReq, MultiUploadObjectResp>(
+        &CosAPI::MultiUploadObject, request, response, callback);
+}
+
+AsyncFuture CosAPI::MultiUploadObjectAsync(const MultiUploadObjectByStreamReq& request,
+                                           MultiUploadObjectResp* response,
+                                           const AsyncCallback& callback) {
+    return ScheduleAsync<MultiUploadObjectByStreamReq, MultiUploadObjectResp>(
+        &CosAPI::MultiUploadObject, request, response, callback);
+}
+
+AsyncFuture CosAPI::HeadObjectAsync(const HeadObjectReq& request,
+                                    HeadObjectResp* response,
+                                    const AsyncCallback& callback) {
+    if (CosSysConfig::IsUseAsyncHttpEngine()) {
+        return SendAsync<HeadObjectReq, HeadObjectResp>(
+            &ObjectOp::HeadObjectAsync, request, response, callback);
+    }
+    return ScheduleAsync<HeadObjectReq, HeadObjectResp>(
+        &CosAPI::HeadObject, request, response, callback);
+}
+
+AsyncFuture CosAPI::DeleteObjectsAsync(const DeleteObjectsReq& request,
+                                       DeleteObjectsResp* response,
+                                       const AsyncCallback& callback) {
+    if (CosSysConfig::IsUseAsyncHttpEngine()) {
+        return SendAsync<DeleteObjectsReq, DeleteObjectsResp>(
+            &ObjectOp::DeleteObjectsAsync, request, response, callback);
+    }
+    return ScheduleAsync<DeleteObjectsReq, DeleteObjectsResp>(
+        &CosAPI::DeleteObjects, request, response, callback);
+}
+
 
 } // namespace qcloud_cos
@@ -87,6 +87,19 @@ bool CosConfig::InitConf(const std::string& config_file) {
         CosSysConfig::SetAsynThreadPoolSize(root["AsynThreadPoolSize"].asInt());
     }
 
+    //异步接口的任务队列长度
+    if (root.isMember("AsynTaskQueueSize")) {
+        CosSysConfig::SetAsynTaskQueueSize(root["AsynTaskQueueSize"].asUInt());
+    }
+
+    if (root.isMember("TransferThreadPoolSize")) {
+        CosSysConfig::SetTransferThreadPoolSize(root["TransferThreadPoolSize"].asUInt());
+    }
+
+    if (root.isMember("MaxInflightTransferTasks")) {
+        CosSysConfig::SetMaxInflightTransferTasks(root["MaxInflightTransferTasks"].asUInt());
+    }
+
     //设置log输出,0:不输出, 1:屏幕,2:syslog,,默认:0
     if (root.isMember("LogoutType")) {
         CosSysConfig::SetLogOutType((LOG_OUT_TYPE)(root["LogoutType"].asInt64()));
@@ -117,10 +130,66 @@ bool CosConfig::InitConf(const std::string& config_file) {
         CosSysConfig::SetKeepIntvl(root["keepalive_interval_time"].asInt());
     }
 
+    // socket参数
+    if (root.isMember("TcpNoDelay")) {
+        CosSysConfig::SetTcpNoDelay(root["TcpNoDelay"].asBool());
+    }
+
+    if (root.isMember("SocketSendBufferSize")) {
+        CosSysConfig::SetSocketSendBufferSize(root["SocketSendBufferSize"].asInt());
+    }
+
+    if (root.isMember("SocketRecvBufferSize")) {
+        CosSysConfig::SetSocketRecvBufferSize(root["SocketRecvBufferSize"].asInt());
+    }
+
+    if (root.isMember("TcpNotSentLowat")) {
+        CosSysConfig::SetTcpNotSentLowat(root["TcpNotSentLowat"].asInt());
+    }
+
+    // 域名解析缓存相关
+    if (root.isMember("IsUseDnsCache")) {
+        CosSysConfig::SetUseDnsCache(root["IsUseDnsCache"].asBool());
+    }
+
+    if (root.isMember("DnsCacheTtlInms")) {
+        CosSysConfig::SetDnsCacheTtlInms(root["DnsCacheTtlInms"].asUInt64());
+    }
+
+    if (root.isMember("DnsNegativeCacheTtlInms")) {
+        CosSysConfig::SetDnsNegativeCacheTtlInms(root["DnsNegativeCacheTtlInms"].asUInt64());
+    }
+
+    // 异步http引擎相关
+    if (root.isMember("IsUseAsyncHttpEngine")) {
+        CosSysConfig::SetUseAsyncHttpEngine(root["IsUseAsyncHttpEngine"].asBool());
+    }
+
+    if (root.isMember("AsyncHttpIoThreadNum")) {
+        CosSysConfig::SetAsyncHttpIoThreadNum(root["AsyncHttpIoThreadNum"].asUInt());
+    }
+
+    // 分块buffer池相关
+    if (root.isMember("BufferPoolMaxSize")) {
+        CosSysConfig::SetBufferPoolMaxSize(root["BufferPoolMaxSize"].asUInt64());
+    }
+
+    if (root.isMember("IsBufferPoolUseHugePage")) {
+        CosSysConfig::SetBufferPoolUseHugePage(root["IsBufferPoolUseHugePage"].asBool());
+    }
+
     if (root.isMember("IsCheckMd5")) {
         CosSysConfig::SetCheckMd5(root["IsCheckMd5"].asBool());
     }
 
+    if (root.isMember("IsCheckCrc64")) {
+        CosSysConfig::SetCheckCrc64(root["IsCheckCrc64"].asBool());
+    }
+
+    if (root.isMember("Md5MismatchPolicy")) {
+        CosSysConfig::SetMd5MismatchPolicy((MD5_MISMATCH_POLICY)(root["Md5MismatchPolicy"].asInt()));
+    }
+
     if (root.isMember("DestDomain")) {
         CosSysConfig::SetDestDomain(root["DestDomain"].asString());
     }
@@ -137,6 +206,40 @@ bool CosConfig::InitConf(const std::string& config_file) {
        CosSysConfig::SetIntranetAddr(root["IntranetAddr"].asString());
     }
 
+    // 连接池相关
+    if (root.isMember("IsUseConnectionPool")) {
+        CosSysConfig::SetUseConnectionPool(root["IsUseConnectionPool"].asBool());
+    }
+
+    if (root.isMember("MaxConnectionsPerHost")) {
+        CosSysConfig::SetMaxConnectionsPerHost(root["MaxConnectionsPerHost"].asUInt());
+    }
+
+    if (root.isMember("ConnectionIdleTimeoutInms")) {
+        CosSysConfig::SetConnectionIdleTimeoutInms(root["ConnectionIdleTimeoutInms"].asUInt64());
+    }
+
+    // https相关
+    if (root.isMember("SslVerifyMode")) {
+        CosSysConfig::SetSslVerifyMode((SSL_VERIFY_MODE)(root["SslVerifyMode"].asInt()));
+    }
+
+    if (root.isMember("SslCipherList")) {
+        CosSysConfig::SetSslCipherList(root["SslCipherList"].asString());
+    }
+
+    if (root.isMember("SslCaLocation")) {
+        CosSysConfig::SetSslCaLocation(root["SslCaLocation"].asString());
+    }
+
+    if (root.isMember("IsUseTlsSessionCache")) {
+        CosSysConfig::SetUseTlsSessionCache(root["IsUseTlsSessionCache"].asBool());
+    }
+
+    if (root.isMember("TlsSessionCacheFile")) {
+        CosSysConfig::SetTlsSessionCacheFile(root["TlsSessionCacheFile"].asString());
+    }
+
     CosSysConfig::PrintValue();
     return true;
 }
@@ -183,4 +286,20 @@ void CosConfig::SetIntranetAddr(const std::string& intranet_addr) {
     CosSysConfig::SetIntranetAddr(intranet_addr);
 }
 
+void CosConfig::SetSslVerifyMode(SSL_VERIFY_MODE mode) {
+    CosSysConfig::SetSslVerifyMode(mode);
+}
+
+void CosConfig::SetSslCipherList(const std::string& cipher_list) {
+    CosSysConfig::SetSslCipherList(cipher_list);
+}
+
+void CosConfig::SetSslCaLocation(const std::string& ca_location) {
+    CosSysConfig::SetSslCaLocation(ca_location);
+}
+
+void CosConfig::SetTlsSessionCacheFile(const std::string& file_path) {
+    CosSysConfig::SetTlsSessionCacheFile(file_path);
+}
+
 } // qcloud_cos
@@ -20,6 +20,9 @@ uint64_t CosSysConfig::m_recv_timeout_in_ms = 5 * 1000;
 
 unsigned CosSysConfig::m_threadpool_size = kDefaultThreadPoolSizeUploadPart;
 unsigned CosSysConfig::m_asyn_threadpool_size = kDefaultPoolSize;
+unsigned CosSysConfig::m_asyn_task_queue_size = kDefaultAsynTaskQueueSize;
+unsigned CosSysConfig::m_transfer_threadpool_size = 0;
+unsigned CosSysConfig::m_max_inflight_transfer_tasks = kDefaultMaxInflightTransferTasks;
 
 //日志输出
 LOG_OUT_TYPE CosSysConfig::m_log_outtype = COS_LOG_STDOUT;
@@ -35,6 +38,8 @@ bool CosSysConfig::m_keep_alive = false;
 int64_t CosSysConfig::m_keep_idle = 20;
 int64_t CosSysConfig::m_keep_intvl = 5;
 bool CosSysConfig::m_is_check_md5 = false;
+bool CosSysConfig::m_is_check_crc64 = true;
+MD5_MISMATCH_POLICY CosSysConfig::m_md5_mismatch_policy = COS_MD5_MISMATCH_KEEP;
 
 // 设置私有云host
 std::string CosSysConfig::m_dest_domain = "";
@@ -44,6 +49,37 @@ bool CosSysConfig::m_is_domain_same_to_host = false;
 std::string CosSysConfig::m_intranet_addr = "";
 bool CosSysConfig::m_is_use_intranet = false;
 
+// 连接池
+bool CosSysConfig::m_use_connection_pool = true;
+unsigned CosSysConfig::m_max_connections_per_host = kDefaultMaxConnectionsPerHost;
+uint64_t CosSysConfig::m_connection_idle_timeout_in_ms = 30 * 1000;
+
+// https相关
+SSL_VERIFY_MODE CosSysConfig::m_ssl_verify_mode = COS_SSL_VERIFY_RELAXED;
+std::string CosSysConfig::m_ssl_cipher_list = "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH";
+std::string CosSysConfig::m_ssl_ca_location = "";
+bool CosSysConfig::m_use_tls_session_cache = true;
+std::string CosSysConfig::m_tls_session_cache_file = "";
+
+// socket相关
+bool CosSysConfig::m_tcp_no_delay = true;
+int CosSysConfig::m_socket_send_buffer_size = 0;
+int CosSysConfig::m_socket_recv_buffer_size = 0;
+int CosSysConfig::m_tcp_not_sent_lowat = 0;
+
+// 域名解析缓存相关
+bool CosSysConfig::m_use_dns_cache = true;
+uint64_t CosSysConfig::m_dns_cache_ttl_in_ms = 60 * 1000;
+uint64_t CosSysConfig::m_dns_negative_cache_ttl_in_ms = 5 * 1000;
+
+// 异步http引擎相关
+bool CosSysConfig::m_use_async_http_engine = false;
+unsigned CosSysConfig::m_async_http_io_thread_num = 2;
+
+// 分块buffer池相关
+uint64_t CosSysConfig::m_buffer_pool_max_size = kDefaultBufferPoolMaxSize;
+bool CosSysConfig::m_buffer_pool_use_huge_page = false;
+
 void CosSysConfig::PrintValue() {
     std::cout << "upload_part_size:" << m_upload_part_size << std::endl;
     std::cout << "upload_copy_part_size:" << m_upload_copy_part_size << std::endl;
@@ -52,6 +88,9 @@ void CosSysConfig::PrintValue() {
     std::cout << "recv_timeout_in_ms:" << m_recv_timeout_in_ms << std::endl;
     std::cout << "threadpool_size:" << m_threadpool_size << std::endl;
     std::cout << "asyn_threadpool_size:" << m_asyn_threadpool_size << std::endl;
+    std::cout << "transfer_threadpool_size:" << m_transfer_threadpool_size << std::endl;
+    std::cout << "max_inflight_transfer_tasks:" << m_max_inflight_transfer_tasks << std::endl;
+    std::cout << "asyn_task_queue_size:" << m_asyn_task_queue_size << std::endl;
     std::cout << "log_outtype:" << m_log_outtype << std::endl;
     std::cout << "log_level:" << m_log_level << std::endl;
     std::cout << "down_thread_pool_max_size:" << m_down_thread_pool_max_size << std::endl;
@@ -59,6 +98,27 @@ void CosSysConfig::PrintValue() {
     std::cout << "keepalive:" << m_keep_alive << std::endl;
     std::cout << "keepidle:" << m_keep_idle << std::endl;
     std::cout << "keepintvl:" << m_keep_intvl << std::endl;
+    std::cout << "is_check_crc64:" << m_is_check_crc64 << std::endl;
+    std::cout << "md5_mismatch_policy:" << m_md5_mismatch_policy << std::endl;
+    std::cout << "use_connection_pool:" << m_use_connection_pool << std::endl;
+    std::cout << "max_connections_per_host:" << m_max_connections_per_host << std::endl;
+    std::cout << "connection_idle_timeout_in_ms:" << m_connection_idle_timeout_in_ms << std::endl;
+    std::cout << "ssl_verify_mode:" << m_ssl_verify_mode << std::endl;
+    std::cout << "ssl_cipher_list:" << m_ssl_cipher_list << std::endl;
+    std::cout << "ssl_ca_location:" << m_ssl_ca_location << std::endl;
+    std::cout << "use_tls_session_cache:" << m_use_tls_session_cache << std::endl;
+    std::cout << "tls_session_cache_file:" << m_tls_session_cache_file << std::endl;
+    std::cout << "tcp_no_delay:" << m_tcp_no_delay << std::endl;
+    std::cout << "socket_send_buffer_size:" << m_socket_send_buffer_size << std::endl;
+    std::cout << "socket_recv_buffer_size:" << m_socket_recv_buffer_size << std::endl;
+    std::cout << "tcp_not_sent_lowat:" << m_tcp_not_sent_lowat << std::endl;
+    std::cout << "use_dns_cache:" << m_use_dns_cache << std::endl;
+    std::cout << "dns_cache_ttl_in_ms:" << m_dns_cache_ttl_in_ms << std::endl;
+    std::cout << "dns_negative_cache_ttl_in_ms:" << m_dns_negative_cache_ttl_in_ms << std::endl;
+    std::cout << "use_async_http_engine:" << m_use_async_http_engine << std::endl;
+    std::cout << "async_http_io_thread_num:" << m_async_http_io_thread_num << std::endl;
+    std::cout << "buffer_pool_max_size:" << m_buffer_pool_max_size << std::endl;
+    std::cout << "buffer_pool_use_huge_page:" << m_buffer_pool_use_huge_page << std::endl;
 }
 
 void CosSysConfig::SetKeepAlive(bool keep_alive) {
@@ -163,6 +223,34 @@ unsigned CosSysConfig::GetAsynThreadPoolSize()
     return m_asyn_threadpool_size;
 }
 
+void CosSysConfig::SetAsynTaskQueueSize(unsigned size) {
+    if (size < kMinAsynTaskQueueSize) {
+        m_asyn_task_queue_size = kMinAsynTaskQueueSize;
+        return;
+    }
+    m_asyn_task_queue_size = size;
+}
+
+void CosSysConfig::SetTransferThreadPoolSize(unsigned size) {
+    m_transfer_threadpool_size = size;
+}
+
+unsigned CosSysConfig::GetTransferThreadPoolSize() {
+    return m_transfer_threadpool_size;
+}
+
+void CosSysConfig::SetMaxInflightTransferTasks(unsigned num) {
+    m_max_inflight_transfer_tasks = num;
+}
+
+unsigned CosSysConfig::GetMaxInflightTransferTasks() {
+    return m_max_inflight_transfer_tasks;
+}
+
+unsigned CosSysConfig::GetAsynTaskQueueSize() {
+    return m_asyn_task_queue_size;
+}
+
 unsigned CosSysConfig::GetUploadThreadPoolSize() {
     return m_threadpool_size;
 }
@@ -211,6 +299,22 @@ void CosSysConfig::SetCheckMd5(bool is_check_md5) {
     m_is_check_md5 = is_check_md5;
 }
 
+void CosSysConfig::SetCheckCrc64(bool is_check_crc64) {
+    m_is_check_crc64 = is_check_crc64;
+}
+
+bool CosSysConfig::IsCheckCrc64() {
+    return m_is_check_crc64;
+}
+
+void CosSysConfig::SetMd5MismatchPolicy(MD5_MISMATCH_POLICY policy) {
+    m_md5_mismatch_policy = policy;
+}
+
+MD5_MISMATCH_POLICY CosSysConfig::GetMd5MismatchPolicy() {
+    return m_md5_mismatch_policy;
+}
+
 bool CosSysConfig::IsDomainSameToHost() {
     return m_is_domain_same_to_host;
 }
@@ -259,4 +363,156 @@ std::string CosSysConfig::GetIntranetAddr() {
     return m_intranet_addr;
 }
 
+void CosSysConfig::SetUseConnectionPool(bool use_connection_pool) {
+    m_use_connection_pool = use_connection_pool;
+}
+
+bool CosSysConfig::IsUseConnectionPool() {
+    return m_use_connection_pool;
+}
+
+void CosSysConfig::SetMaxConnectionsPerHost(unsigned max_connections) {
+    m_max_connections_per_host = max_connections;
+}
+
+unsigned CosSysConfig::GetMaxConnectionsPerHost() {
+    return m_max_connections_per_host;
+}
+
+void CosSysConfig::SetConnectionIdleTimeoutInms(uint64_t time) {
+    m_connection_idle_timeout_in_ms = time;
+}
+
+uint64_t CosSysConfig::GetConnectionIdleTimeoutInms() {
+    return m_connection_idle_timeout_in_ms;
+}
+
+void CosSysConfig::SetSslVerifyMode(SSL_VERIFY_MODE mode) {
+    m_ssl_verify_mode = mode;
+}
+
+SSL_VERIFY_MODE CosSysConfig::GetSslVerifyMode() {
+    return m_ssl_verify_mode;
+}
+
+void CosSysConfig::SetSslCipherList(const std::string& cipher_list) {
+    m_ssl_cipher_list = cipher_list;
+}
+
+std::string CosSysConfig::GetSslCipherList() {
+    return m_ssl_cipher_list;
+}
+
+void CosSysConfig::SetSslCaLocation(const std::string& ca_location) {
+    m_ssl_ca_location = ca_location;
+}
+
+std::string CosSysConfig::GetSslCaLocation() {
+    return m_ssl_ca_location;
+}
+
+void CosSysConfig::SetUseTlsSessionCache(bool use_tls_session_cache) {
+    m_use_tls_session_cache = use_tls_session_cache;
+}
+
+bool CosSysConfig::IsUseTlsSessionCache() {
+    return m_use_tls_session_cache;
+}
+
+void CosSysConfig::SetTlsSessionCacheFile(const std::string& file_path) {
+    m_tls_session_cache_file = file_path;
+}
+
+std::string CosSysConfig::GetTlsSessionCacheFile() {
+    return m_tls_session_cache_file;
+}
+
+void CosSysConfig::SetTcpNoDelay(bool tcp_no_delay) {
+    m_tcp_no_delay = tcp_no_delay;
+}
+
+bool CosSysConfig::IsTcpNoDelay() {
+    return m_tcp_no_delay;
+}
+
+void CosSysConfig::SetSocketSendBufferSize(int size) {
+    m_socket_send_buffer_size = size;
+}
+
+int CosSysConfig::GetSocketSendBufferSize() {
+    return m_socket_send_buffer_size;
+}
+
+void CosSysConfig::SetSocketRecvBufferSize(int size) {
+    m_socket_recv_buffer_size = size;
+}
+
+int CosSysConfig::GetSocketRecvBufferSize() {
+    return m_socket_recv_buffer_size;
+}
+
+void CosSysConfig::SetTcpNotSentLowat(int size) {
+    m_tcp_not_sent_lowat = size;
+}
+
+int CosSysConfig::GetTcpNotSentLowat() {
+    return m_tcp_not_sent_lowat;
+}
+
+void CosSysConfig::SetUseDnsCache(bool use_dns_cache) {
+    m_use_dns_cache = use_dns_cache;
+}
+
+bool CosSysConfig::IsUseDnsCache() {
+    return m_use_dns_cache;
+}
+
+void CosSysConfig::SetDnsCacheTtlInms(uint64_t time) {
+    m_dns_cache_ttl_in_ms = time;
+}
+
+uint64_t CosSysConfig::GetDnsCacheTtlInms() {
+    return m_dns_cache_ttl_in_ms;
+}
+
+void CosSysConfig::SetDnsNegativeCacheTtlInms(uint64_t time) {
+    m_dns_negative_cache_ttl_in_ms = time;
+}
+
+uint64_t CosSysConfig::GetDnsNegativeCacheTtlInms() {
+    return m_dns_negative_cache_ttl_in_ms;
+}
+
+void CosSysConfig::SetUseAsyncHttpEngine(bool use_async_http_engine) {
+    m_use_async_http_engine = use_async_http_engine;
+}
+
+bool CosSysConfig::IsUseAsyncHttpEngine() {
+    return m_use_async_http_engine;
+}
+
+void CosSysConfig::SetAsyncHttpIoThreadNum(unsigned thread_num) {
+    m_async_http_io_thread_num = thread_num;
+}
+
+unsigned CosSysConfig::GetAsyncHttpIoThreadNum() {
+    return m_async_http_io_thread_num;
+}
+
+void CosSysConfig::SetBufferPoolMaxSize(uint64_t max_size) {
+    m_buffer_pool_max_size = max_size;
+}
+
+uint64_t CosSysConfig::GetBufferPoolMaxSize() {
+    return m_buffer_pool_max_size;
+}
+
+void CosSysConfig::SetBufferPoolUseHugePage(bool use_huge_page) {
+    m_buffer_pool_use_huge_page = use_huge_page;
+}
+
+bool CosSysConfig::IsBufferPoolUseHugePage() {
+    return m_buffer_pool_use_huge_page;
+}
+
 }
@@ -9,15 +9,33 @@
 
 #include <iostream>
 
+#include "boost/bind.hpp"
+#include "Poco/Event.h"
+
 #include "cos_sys_config.h"
 #include "request/base_req.h"
 #include "response/base_resp.h"
+#include "util/async_http_sender.h"
 #include "util/auth_tool.h"
 #include "util/http_sender.h"
 #include "util/codec_util.h"
 
 namespace qcloud_cos{
 
+namespace {
+
+struct SyncActionContext {
+    Poco::Event m_event;
+    CosResult m_result;
+};
+
+void OnSyncActionDone(SyncActionContext* ctx, const CosResult& result) {
+    ctx->m_result = result;
+    ctx->m_event.set();
+}
+
+} // namespace
+
 CosConfig BaseOp::GetCosConfig() const {
     return *m_config;
 }
@@ -54,42 +72,103 @@ CosResult BaseOp::NormalAction(const std::string& host,
                                const std::string& req_body,
                                bool check_body,
                                BaseResp* resp) {
+    if (CosSysConfig::IsUseAsyncHttpEngine()) {
+        // 同步接口本身需要等待结果, 请求仍由I/O线程驱动
+        SyncActionContext ctx;
+        NormalActionAsync(host, path, req, additional_headers, additional_params, req_body,
+                          check_body, resp, boost::bind(&OnSyncActionDone, &ctx, _1));
+        ctx.m_event.wait();
+        return ctx.m_result;
+    }
+
     CosResult result;
-    std::map<std::string, std::string> req_headers = req.GetHeaders();
-    std::map<std::string, std::string> req_params = req.GetParams();
-    req_headers.insert(additional_headers.begin(), additional_headers.end());
-    req_params.insert(additional_params.begin(), additional_params.end());
+    std::map<std::string, std::string> req_headers;
+    std::map<std::string, std::string> req_params;
+    if (!BuildRequest(host, req, additional_headers, additional_params,
+                      &req_headers, &req_params, &result)) {
+        return result;
+    }
+
+    // 3. 发送请求
+    std::map<std::string, std::string> resp_headers;
+    std::string resp_body;
+
+    std::string dest_url = GetRealUrl(host, path, req.IsHttps());
+    std::string err_msg = "";
+    int http_code = HttpSender::SendRequest(req.GetMethod(), dest_url, req_params, req_headers,
+                                    req_body, req.GetConnTimeoutInms(), req.GetRecvTimeoutInms(),
+                                    &resp_headers, &resp_body, &err_msg);
+    return ParseNormalResponse(http_code, resp_headers, resp_body, err_msg, check_body, resp);
+}
+
+void BaseOp::NormalActionAsync(const std::string& host,
+                               const std::string& path,
+                               const BaseReq& req,
+                               const std::map<std::string, std::string>& additional_headers,
+                               const std::map<std::string, std::string>& additional_params,
+                               const std::string& req_body,
+                               bool check_body,
+                               BaseResp* resp,
+                               const AsyncCallback& callback) {
+    CosResult result;
+    std::map<std::string, std::string> req_headers;
+    std::map<std::string, std::string> req_params;
+    if (!BuildRequest(host, req, additional_headers, additional_params,
+                      &req_headers, &req_params, &result)) {
+        callback(result);
+        return;
+    }
+
+    // 3. 发送请求, 请求在返回前已序列化, req和body不需要保持到请求完成
+    std::string dest_url = GetRealUrl(host, path, req.IsHttps());
+    AsyncHttpSender::SendRequest(req.GetMethod(), dest_url, req_params, req_headers, req_body,
+                                 req.GetConnTimeoutInms(), req.GetRecvTimeoutInms(),
+                                 boost::bind(&BaseOp::OnNormalActionDone, check_body, resp,
+                                             callback, _1));
+}
+
+bool BaseOp::BuildRequest(const std::string& host,
+                          const BaseReq& req,
+                          const std::map<std::string, std::string>& additional_headers,
+                          const std::map<std::string, std::string>& additional_params,
+                          std::map<std::string, std::string>* req_headers,
+                          std::map<std::string, std::string>* req_params,
+                          CosResult* result) {
+    *req_headers = req.GetHeaders();
+    *req_params = req.GetParams();
+    req_headers->insert(additional_headers.begin(), additional_headers.end());
+    req_params->insert(additional_params.begin(), additional_params.end());
     const std::string& tmp_token = m_config->GetTmpToken();
     if (!tmp_token.empty()) {
-        req_headers["x-cos-security-token"] = tmp_token;
+        (*req_headers)["x-cos-security-token"] = tmp_token;
     }
 
     // 1. 获取host
     if (!CosSysConfig::IsDomainSameToHost()) {
-        req_headers["Host"] = host;
+        (*req_headers)["Host"] = host;
     } else {
-        req_headers["Host"] = CosSysConfig::GetDestDomain();
+        (*req_headers)["Host"] = CosSysConfig::GetDestDomain();
     }
 
     // 2. 计算签名
     std::string auth_str = AuthTool::Sign(GetAccessKey(), GetSecretKey(),
                                           req.GetMethod(), req.GetPath(),
-                                          req_headers, req_params);
+                                          *req_headers, *req_params);
     if (auth_str.empty()) {
-        result.SetErrorInfo("Generate auth str fail, check your access_key/secret_key.");
-        return result;
+        result->SetErrorInfo("Generate auth str fail, check your access_key/secret_key.");
+        return false;
     }
-    req_headers["Authorization"] = auth_str;
-
-    // 3. 发送请求
-    std::map<std::string, std::string> resp_headers;
-    std::string resp_body;
+    (*req_headers)["Authorization"] = auth_str;
+    return true;
+}
 
-    std::string dest_url = GetRealUrl(host, path, req.IsHttps());
-    std::string err_msg = "";
-    int http_code = HttpSender::SendRequest(req.GetMethod(), dest_url, req_params, req_headers,
-                                    req_body, req.GetConnTimeoutInms(), req.GetRecvTimeoutInms(),
-                                    &resp_headers, &resp_body, &err_msg);
+CosResult BaseOp::ParseNormalResponse(int http_code,
+                                      const std::map<std::string, std::string>& resp_headers,
+                                      const std::string& resp_body,
+                                      const std::string& err_msg,
+                                      bool check_body,
+                                      BaseResp* resp) {
+    CosResult result;
     if (http_code == -1) {
         result.SetErrorInfo(err_msg);
         return result;
@@ -120,12 +199,33 @@ CosResult BaseOp::NormalAction(const std::string& host,
     return result;
 }
 
+void BaseOp::OnNormalActionDone(bool check_body, BaseResp* resp,
+                                const AsyncCallback& callback,
+                                const AsyncHttpResult& http_result) {
+    CosResult result;
+    try {
+        result = ParseNormalResponse(http_result.m_http_code, http_result.m_resp_headers,
+                                     http_result.m_resp_body, http_result.m_err_msg,
+                                     check_body, resp);
+    } catch (const std::exception& ex) {
+        // 异常不能抛回I/O线程, 否则callback不会被调用
+        SDK_LOG_ERR("Parse response throw exception: %s", ex.what());
+        result.SetFail();
+        result.SetErrorInfo(std::string("Parse response throw exception: ") + ex.what());
+    }
+    callback(result);
+}
+
 CosResult BaseOp::DownloadAction(const std::string& host,
                                  const std::string& path,
                                  const BaseReq& req,
                                  BaseResp* resp,
-                                 std::ostream& os) {
+                                 std::ostream& os,
+                                 bool* is_md5_mismatch) {
     CosResult result;
+    if (is_md5_mismatch != NULL) {
+        *is_md5_mismatch = false;
+    }
     std::map<std::string, std::string> req_headers = req.GetHeaders();
     std::map<std::string, std::string> req_params = req.GetParams();
     const std::string& tmp_token = m_config->GetTmpToken();
@@ -161,6 +261,13 @@ CosResult BaseOp::DownloadAction(const std::string& host,
                                             "", req.GetConnTimeoutInms(), req.GetRecvTimeoutInms(),
                                             &resp_headers, &xml_err_str, os, &err_msg,
                                             &real_byte, req.CheckMD5());
+    if (http_code == kHttpCodeMd5Mismatch) {
+        if (is_md5_mismatch != NULL) {
+            *is_md5_mismatch = true;
+        }
+        result.SetErrorInfo(err_msg);
+        return result;
+    }
     if (http_code == -1) {
         result.SetErrorInfo(err_msg);
         return result;
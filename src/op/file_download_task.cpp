@@ -1,12 +1,139 @@
 #include "op/file_download_task.h"
 
+#include <errno.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <map>
 
+#include "util/crc64.h"
+
 namespace qcloud_cos{
 
+FileDownSliceQueue::FileDownSliceQueue(uint64_t file_size, uint64_t slice_size, int fd,
+                                       DownloadCheckpoint* checkpoint,
+                                       const std::string& checkpoint_file)
+    : m_file_size(file_size), m_slice_size(slice_size),
+      m_next_offset(0), m_is_stopped(false), m_fd(fd),
+      m_checkpoint(checkpoint), m_checkpoint_file(checkpoint_file),
+      m_is_flushing(false), m_last_flush_in_ms(HttpSender::GetTimeStampInUs() / 1000) {
+    if (m_checkpoint == NULL) {
+        return;
+    }
+
+    // 续传前已下载的分片不会再经过Done, 用checkpoint中的CRC64参与整个文件的校验
+    for (uint64_t offset = 0; offset < m_file_size; offset += m_slice_size) {
+        uint64_t slice_index = offset / m_slice_size;
+        if (m_checkpoint->IsSliceDone(slice_index)) {
+            m_slice_crc64s[offset] = m_checkpoint->GetSliceCrc64(slice_index);
+        }
+    }
+}
+
+bool FileDownSliceQueue::Next(uint64_t* offset, size_t* len) {
+    SimpleMutexLocker locker(&m_mutex);
+    if (m_checkpoint != NULL) {
+        while (m_next_offset < m_file_size
+               && m_checkpoint->IsSliceDone(m_next_offset / m_slice_size)) {
+            m_next_offset += m_slice_size;
+        }
+    }
+
+    if (m_is_stopped || m_next_offset >= m_file_size) {
+        return false;
+    }
+
+    *offset = m_next_offset;
+    *len = MIN(m_slice_size, m_file_size - m_next_offset);
+    m_next_offset += *len;
+    return true;
+}
+
+void FileDownSliceQueue::Done(uint64_t offset, uint64_t crc64) {
+    {
+        SimpleMutexLocker locker(&m_mutex);
+        m_slice_crc64s[offset] = crc64;
+        if (m_checkpoint == NULL) {
+            return;
+        }
+
+        m_pending_slices.push_back(offset / m_slice_size);
+        uint64_t now_in_ms = HttpSender::GetTimeStampInUs() / 1000;
+        if (m_pending_slices.size() < kDownloadCheckpointFlushSliceNum
+            && now_in_ms - m_last_flush_in_ms < kDownloadCheckpointFlushIntervalInms) {
+            return;
+        }
+    }
+    Flush();
+}
+
+void FileDownSliceQueue::Flush() {
+    std::vector<uint64_t> slices;
+    {
+        SimpleMutexLocker locker(&m_mutex);
+        if (m_checkpoint == NULL || m_is_flushing || m_pending_slices.empty()) {
+            return;
+        }
+        m_is_flushing = true;
+        slices.swap(m_pending_slices);
+    }
+
+    // pwrite的数据可能还在page cache中, 必须先落盘再标记分片完成,
+    // 否则掉电后续传会把未写入的空洞当作已下载的内容
+    bool is_synced = (fdatasync(m_fd) == 0);
+    if (!is_synced) {
+        SDK_LOG_ERR("Sync download file fail, errno=%d", errno);
+    }
+
+    DownloadCheckpoint snapshot;
+    {
+        SimpleMutexLocker locker(&m_mutex);
+        if (is_synced) {
+            for (std::vector<uint64_t>::const_iterator itr = slices.begin();
+                 itr != slices.end(); ++itr) {
+                m_checkpoint->SetSliceDone(*itr, m_slice_crc64s[*itr * m_slice_size]);
+            }
+            snapshot = *m_checkpoint;
+        } else {
+            m_pending_slices.insert(m_pending_slices.end(), slices.begin(), slices.end());
+        }
+        m_last_flush_in_ms = HttpSender::GetTimeStampInUs() / 1000;
+    }
+
+    // 同一时间只有一个线程写checkpoint文件, 写文件时不持有队列锁
+    if (is_synced) {
+        snapshot.Save(m_checkpoint_file);
+    }
+
+    SimpleMutexLocker locker(&m_mutex);
+    m_is_flushing = false;
+}
+
+bool FileDownSliceQueue::GetCrc64(uint64_t* crc64) {
+    SimpleMutexLocker locker(&m_mutex);
+    uint64_t crc = 0;
+    for (uint64_t offset = 0; offset < m_file_size; offset += m_slice_size) {
+        std::map<uint64_t, uint64_t>::const_iterator itr = m_slice_crc64s.find(offset);
+        if (itr == m_slice_crc64s.end()) {
+            return false;
+        }
+        crc = Crc64::Combine(crc, itr->second, MIN(m_slice_size, m_file_size - offset));
+    }
+    *crc64 = crc;
+    return true;
+}
+
+void FileDownSliceQueue::Stop() {
+    SimpleMutexLocker locker(&m_mutex);
+    m_is_stopped = true;
+}
+
+bool FileDownSliceQueue::IsStopped() {
+    SimpleMutexLocker locker(&m_mutex);
+    return m_is_stopped;
+}
+
 FileDownTask::FileDownTask(const std::string& full_url,
                            const std::map<std::string, std::string>& headers,
                            const std::map<std::string, std::string>& params,
@@ -19,7 +146,8 @@ FileDownTask::FileDownTask(const std::string& full_url,
       m_conn_timeout_in_ms(conn_timeout_in_ms),
       m_recv_timeout_in_ms(recv_timeout_in_ms),
       m_offset(offset), m_data_buf_ptr(pbuf),
-      m_data_len(data_len), m_resp(""), m_is_task_success(false), m_real_down_len(0) {
+      m_data_len(data_len), m_resp(""), m_is_task_success(false), m_real_down_len(0),
+      m_http_status(-1), m_fd(-1), m_crc64(0) {
 }
 
 void FileDownTask::Run() {
@@ -28,6 +156,43 @@ void FileDownTask::Run() {
     DownTask();
 }
 
+void FileDownTask::Run(FileDownSliceQueue* slice_queue, int fd) {
+    m_is_task_success = true;
+    m_data_buf_ptr = NULL;
+    m_fd = fd;
+
+    uint64_t offset = 0;
+    size_t len = 0;
+    while (slice_queue->Next(&offset, &len)) {
+        m_offset = offset;
+        m_data_len = len;
+
+        // 只重试网络错误和服务端错误, 4xx重试也不会成功
+        int loop = 0;
+        do {
+            ++loop;
+            m_is_task_success = false;
+            DownTask();
+            if (m_is_task_success && m_real_down_len != len) {
+                SDK_LOG_ERR("FileDownload: url(%s) offset=%lu expect len=%lu, but got %lu",
+                            m_full_url.c_str(), offset, len, m_real_down_len);
+                m_err_msg = "download slice length mismatch, offset="
+                    + StringUtil::Uint64ToString(offset);
+                m_http_status = -1;
+                m_is_task_success = false;
+            }
+        } while (!m_is_task_success && (m_http_status == -1 || m_http_status >= 500)
+                 && loop <= kMaxRetryTimes && !slice_queue->IsStopped());
+
+        if (!m_is_task_success) {
+            slice_queue->Stop();
+            return;
+        }
+
+        slice_queue->Done(offset, m_crc64);
+    }
+}
+
 void FileDownTask::SetDownParams(unsigned char* pbuf, size_t data_len, uint64_t offset) {
     m_data_buf_ptr = pbuf;
     m_data_len  = data_len;
@@ -63,9 +228,24 @@ void FileDownTask::DownTask() {
     // 增加Range头域，避免大文件时将整个文件下载
     m_headers["Range"] = range_head;
 
-    m_http_status = HttpSender::SendRequest("GET", m_full_url, m_params, m_headers,
-                                            "", m_conn_timeout_in_ms, m_recv_timeout_in_ms,
-                                            &m_resp_headers, &m_resp, &m_err_msg);
+    m_resp = "";
+    m_resp_headers.clear();
+    m_real_down_len = 0;
+    m_crc64 = 0;
+    uint64_t* crc64 = CosSysConfig::IsCheckCrc64() ? &m_crc64 : NULL;
+
+    // 返回的数据直接写入文件或分片buffer, 不经过中间string
+    if (m_fd >= 0) {
+        m_http_status = HttpSender::SendRequest("GET", m_full_url, m_params, m_headers,
+                                                "", m_conn_timeout_in_ms, m_recv_timeout_in_ms,
+                                                &m_resp_headers, m_fd, m_offset,
+                                                &m_real_down_len, &m_resp, &m_err_msg, crc64);
+    } else {
+        m_http_status = HttpSender::SendRequest("GET", m_full_url, m_params, m_headers,
+                                                "", m_conn_timeout_in_ms, m_recv_timeout_in_ms,
+                                                &m_resp_headers, m_data_buf_ptr, m_data_len,
+                                                &m_real_down_len, &m_resp, &m_err_msg, crc64);
+    }
 
     //当实际长度小于请求的数据长度时httpcode为206
     if (m_http_status != 200 && m_http_status != 206) {
@@ -76,12 +256,7 @@ void FileDownTask::DownTask() {
         return;
     }
 
-    size_t buf_max_size = m_data_len;
-    size_t len = MIN(m_resp.length(), buf_max_size);
-    memcpy(m_data_buf_ptr, m_resp.c_str(), len);
-    m_real_down_len = len;
     m_is_task_success = true;
-    m_resp = "";
     return;
 }
 
@@ -3,13 +3,12 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
 #include <map>
-#include <sstream>
 
 #include "Poco/MD5Engine.h"
-#include "Poco/DigestStream.h"
-#include "Poco/StreamCopier.h"
 
+#include "util/crc64.h"
 #include "util/string_util.h"
 
 namespace qcloud_cos{
@@ -21,7 +20,7 @@ FileUploadTask::FileUploadTask(const std::string& full_url,
                                const size_t data_len)
     : m_full_url(full_url), m_data_buf_ptr(pbuf), m_data_len(data_len),
       m_conn_timeout_in_ms(conn_timeout_in_ms), m_recv_timeout_in_ms(recv_timeout_in_ms),
-      m_resp(""), m_is_task_success(false) {
+      m_resp(""), m_is_task_success(false), m_crc64(0) {
 }
 
 FileUploadTask::FileUploadTask(const std::string& full_url,
@@ -33,7 +32,8 @@ FileUploadTask::FileUploadTask(const std::string& full_url,
                                const size_t data_len)
     : m_full_url(full_url), m_headers(headers), m_params(params),
       m_conn_timeout_in_ms(conn_timeout_in_ms), m_recv_timeout_in_ms(recv_timeout_in_ms),
-      m_data_buf_ptr(pbuf), m_data_len(data_len), m_resp(""), m_is_task_success(false) {
+      m_data_buf_ptr(pbuf), m_data_len(data_len), m_resp(""), m_is_task_success(false),
+      m_crc64(0) {
 }
 
 void FileUploadTask::Run() {
@@ -76,21 +76,25 @@ void FileUploadTask::SetHeaders(const std::map<std::string, std::string>& header
 void FileUploadTask::UploadTask() {
     int loop = 0;
 
-    std::string body((const char *)m_data_buf_ptr, m_data_len);
-    // 计算上传的md5
+    // 直接对上传buffer计算md5, 发送时也直接使用该buffer, 避免拷贝整个分块.
+    // md5和crc64按L2缓存大小分段交替计算, 整个分块只从内存读取一遍
     Poco::MD5Engine md5;
-    std::istringstream istr(body);
-    Poco::DigestOutputStream dos(md5);
-    Poco::StreamCopier::copyStream(istr, dos);
-    dos.close();
+    m_crc64 = 0;
+    for (size_t offset = 0; offset < m_data_len; offset += kHashSliceSize) {
+        size_t len = std::min(kHashSliceSize, m_data_len - offset);
+        md5.update(m_data_buf_ptr + offset, len);
+        m_crc64 = Crc64::Calc(m_crc64, m_data_buf_ptr + offset, len);
+    }
     const std::string& md5_str = Poco::DigestEngine::digestToHex(md5.digest());
+    const std::string& crc64_str = StringUtil::Uint64ToString(m_crc64);
 
     do {
         loop++;
         m_resp_headers.clear();
         m_resp = "";
         m_http_status = HttpSender::SendRequest("PUT", m_full_url, m_params, m_headers,
-                                        body, m_conn_timeout_in_ms, m_recv_timeout_in_ms,
+                                        m_data_buf_ptr, m_data_len,
+                                        m_conn_timeout_in_ms, m_recv_timeout_in_ms,
                                         &m_resp_headers, &m_resp, &m_err_msg);
 
         if (m_http_status != 200) {
@@ -108,6 +112,16 @@ void FileUploadTask::UploadTask() {
             continue;
         }
 
+        // 服务端返回了分块的CRC64时一并校验
+        c_itr = m_resp_headers.find(kHttpHeaderXCosHashCrc64Ecma);
+        if (CosSysConfig::IsCheckCrc64() && c_itr != m_resp_headers.end()
+            && c_itr->second != crc64_str) {
+            SDK_LOG_ERR("Response crc64 is not correct, try again. Expect crc64 is %s,"
+                        " but return crc64 is %s.", crc64_str.c_str(), c_itr->second.c_str());
+            m_is_task_success = false;
+            continue;
+        }
+
         m_is_task_success = true;
     } while (!m_is_task_success && loop <= kMaxRetryTimes);
 
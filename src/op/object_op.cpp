@@ -9,21 +9,31 @@
 
 #include <fcntl.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
+#include <algorithm>
+#include <deque>
+#include <exception>
 #include <map>
 
-#include "threadpool/boost/threadpool.hpp"
 #include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "cos_sys_config.h"
 #include "op/file_copy_task.h"
 #include "op/file_download_task.h"
 #include "op/file_upload_task.h"
 #include "util/auth_tool.h"
+#include "util/buffer_pool.h"
+#include "util/crc64.h"
 #include "util/file_util.h"
 #include "util/http_sender.h"
+#include "util/md5_tee_stream.h"
 #include "util/string_util.h"
+#include "util/transfer_executor.h"
 
 #include "Poco/MD5Engine.h"
 #include "Poco/DigestStream.h"
@@ -31,6 +41,181 @@
 
 namespace qcloud_cos {
 
+namespace {
+
+// 多线程任务的完成队列, 任务执行完后把自己的下标放入队列,
+// 主线程从中按完成顺序回收任务(以及任务使用的buffer)
+class TaskDoneQueue {
+public:
+    void Push(int task_index) {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        m_done_tasks.push_back(task_index);
+        m_cond.notify_one();
+    }
+
+    int Pop() {
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        while (m_done_tasks.empty()) {
+            m_cond.wait(lock);
+        }
+        int task_index = m_done_tasks.front();
+        m_done_tasks.pop_front();
+        return task_index;
+    }
+
+private:
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::deque<int> m_done_tasks;
+};
+
+// Run抛出异常时也必须通知, 否则等待该分块的Pop会一直阻塞.
+// 异常时任务保持未成功的状态, 由调用方按失败处理
+template <class Task>
+void RunTaskAndNotify(Task* task, int task_index, TaskDoneQueue* done_queue) {
+    try {
+        task->Run();
+    } catch (const std::exception& e) {
+        SDK_LOG_ERR("Run transfer task throw exception: %s", e.what());
+    } catch (...) {
+        SDK_LOG_ERR("Run transfer task throw unknown exception");
+    }
+    done_queue->Push(task_index);
+}
+
+// 检查分片上传任务的结果, 成功则按分片号记录etag, 失败则填充result
+bool CheckUploadTask(const FileUploadTask* ptask, uint64_t part_number,
+                     std::map<uint64_t, std::string>* part_etags,
+                     std::map<uint64_t, uint64_t>* part_crc64s, CosResult* result) {
+    if (!ptask->IsTaskSuccess()) {
+        const std::string& task_resp = ptask->GetTaskResp();
+        const std::map<std::string, std::string>& task_resp_headers = ptask->GetRespHeaders();
+        SDK_LOG_ERR("upload data, upload task fail, part_number=%lu, rsp:%s",
+                    part_number, task_resp.c_str());
+        result->SetFail();
+        result->SetHttpStatus(ptask->GetHttpStatus());
+        if (ptask->GetHttpStatus() == -1) {
+            result->SetErrorInfo(ptask->GetErrMsg());
+        } else if (!result->ParseFromHttpResponse(task_resp_headers, task_resp)) {
+            result->SetErrorInfo(task_resp);
+        }
+        return false;
+    }
+
+    // 找不到etag也算失败
+    const std::map<std::string, std::string>& resp_header = ptask->GetRespHeaders();
+    std::map<std::string, std::string>::const_iterator itr = resp_header.find("ETag");
+    if (itr == resp_header.end()) {
+        std::string err_info = "upload data, upload task succ, "
+            "but response header missing etag field.";
+        SDK_LOG_ERR("%s", err_info.c_str());
+        result->SetFail();
+        result->SetErrorInfo(err_info);
+        result->SetHttpStatus(ptask->GetHttpStatus());
+        return false;
+    }
+
+    (*part_etags)[part_number] = itr->second;
+    (*part_crc64s)[part_number] = ptask->GetCrc64();
+    return true;
+}
+
+// 把MultiUploadObject请求中的加密方式、自定义元数据以及超时时间带到Init请求中
+void FillInitMultiUploadReq(const MultiUploadObjectBaseReq& req, InitMultiUploadReq* init_req) {
+    const std::string& server_side_encryption = req.GetHeader("x-cos-server-side-encryption");
+    if (!server_side_encryption.empty()) {
+        init_req->SetXCosServerSideEncryption(server_side_encryption);
+    }
+
+    if (req.IsSetXCosMeta()) {
+        const std::map<std::string, std::string> xcos_meta = req.GetXCosMeta();
+        std::map<std::string, std::string>::const_iterator iter = xcos_meta.begin();
+        for(; iter != xcos_meta.end(); iter++) {
+            init_req->SetXCosMeta(iter->first, iter->second);
+        }
+    }
+
+    init_req->SetConnTimeoutInms(req.GetConnTimeoutInms());
+    init_req->SetRecvTimeoutInms(req.GetRecvTimeoutInms());
+}
+
+// 按分块号顺序合并各分块的CRC64得到整个文件的CRC64(十进制字符串),
+// 续传前已上传的分块使用checkpoint中记录的CRC64, 有分块缺少CRC64时返回空串
+std::string CombinePartCrc64(const std::map<uint64_t, uint64_t>& part_crc64s,
+                             uint64_t part_num, uint64_t part_size, uint64_t file_size) {
+    if (part_num == 0) {
+        return "";
+    }
+
+    uint64_t crc64 = 0;
+    for (uint64_t part_number = 1; part_number <= part_num; ++part_number) {
+        std::map<uint64_t, uint64_t>::const_iterator itr = part_crc64s.find(part_number);
+        if (itr == part_crc64s.end()) {
+            return "";
+        }
+        uint64_t part_offset = (part_number - 1) * part_size;
+        uint64_t part_len = std::min(part_size, file_size - part_offset);
+        crc64 = Crc64::Combine(crc64, itr->second, part_len);
+    }
+    return StringUtil::Uint64ToString(crc64);
+}
+
+// 断点续传时把刚上传成功的分块写入checkpoint文件, checkpoint为NULL时不做任何操作.
+// 写文件失败不影响本次上传, 只是中断后需要重新上传该分块
+void SaveUploadCheckpoint(UploadCheckpoint* checkpoint, const std::string& checkpoint_file,
+                          uint64_t part_number, const std::map<uint64_t, std::string>& part_etags,
+                          const std::map<uint64_t, uint64_t>& part_crc64s) {
+    if (checkpoint == NULL) {
+        return;
+    }
+
+    std::map<uint64_t, std::string>::const_iterator itr = part_etags.find(part_number);
+    std::map<uint64_t, uint64_t>::const_iterator crc_itr = part_crc64s.find(part_number);
+    if (itr != part_etags.end() && crc_itr != part_crc64s.end()) {
+        checkpoint->AddPart(part_number, itr->second, crc_itr->second);
+        checkpoint->Save(checkpoint_file);
+    }
+}
+
+// 从进程共享的BufferPool申请最多max_num个分块buffer, 返回实际申请到的个数.
+// 只有第一个buffer会阻塞等待, 其余的在额度不足时放弃, 以降低本次传输的并发为代价
+// 避免多个传输各持有部分buffer时互相等待; 返回0表示系统分配内存失败
+int AcquirePartBuffers(uint64_t part_size, int max_num, unsigned char** bufs) {
+    BufferPool& pool = BufferPool::Instance();
+    bufs[0] = pool.Acquire(part_size);
+    if (bufs[0] == NULL) {
+        return 0;
+    }
+
+    int num = 1;
+    for (; num < max_num; ++num) {
+        bufs[num] = pool.TryAcquire(part_size);
+        if (bufs[num] == NULL) {
+            break;
+        }
+    }
+    return num;
+}
+
+void ReleasePartBuffers(uint64_t part_size, int num, unsigned char** bufs) {
+    for (int i = 0; i < num; ++i) {
+        BufferPool::Instance().Release(bufs[i], part_size);
+    }
+}
+
+// 生成DeleteObjects的请求body及对应的Content-MD5头
+bool BuildDeleteObjectsBody(const DeleteObjectsReq& req, std::string* req_body,
+                            std::map<std::string, std::string>* headers) {
+    if (!req.GenerateRequestBody(req_body)) {
+        return false;
+    }
+    std::string raw_md5 = CodecUtil::Base64Encode(CodecUtil::RawMd5(*req_body));
+    headers->insert(std::make_pair("Content-MD5", raw_md5));
+    return true;
+}
+
+} // namespace
+
 bool ObjectOp::IsObjectExist(const std::string& bucket_name, const std::string& object_name) {
     HeadObjectReq req(bucket_name, object_name);
     HeadObjectResp resp;
@@ -49,6 +234,17 @@ CosResult ObjectOp::HeadObject(const HeadObjectReq& req, HeadObjectResp* resp) {
     return NormalAction(host, path, req, "", false, resp);
 }
 
+void ObjectOp::HeadObjectAsync(const HeadObjectReq& req, HeadObjectResp* resp,
+                               const AsyncCallback& callback) {
+    std::string host = CosSysConfig::GetHost(GetAppId(), m_config->GetRegion(),
+                                             req.GetBucketName());
+    std::string path = req.GetPath();
+    std::map<std::string, std::string> additional_headers;
+    std::map<std::string, std::string> additional_params;
+    NormalActionAsync(host, path, req, additional_headers, additional_params, "",
+                      false, resp, callback);
+}
+
 CosResult ObjectOp::GetObject(const GetObjectByStreamReq& req,
                               GetObjectByStreamResp* resp) {
     std::string host = CosSysConfig::GetHost(GetAppId(), m_config->GetRegion(),
@@ -70,9 +266,26 @@ CosResult ObjectOp::GetObject(const GetObjectByFileReq& req,
         result.SetErrorInfo("Open local file fail, local file=" + req.GetLocalFilePath());
         return result;
     }
-    result = DownloadAction(host, path, req, resp, ofs);
+    bool is_md5_mismatch = false;
+    result = DownloadAction(host, path, req, resp, ofs, &is_md5_mismatch);
     ofs.close();
 
+    // MD5校验失败时本地文件内容不可信, 按配置删除或标记;
+    // 404/304或网络错误等其他失败不处理本地文件
+    if (is_md5_mismatch) {
+        const std::string& local_path = req.GetLocalFilePath();
+        MD5_MISMATCH_POLICY policy = CosSysConfig::GetMd5MismatchPolicy();
+        if (policy == COS_MD5_MISMATCH_DELETE) {
+            ::remove(local_path.c_str());
+        } else if (policy == COS_MD5_MISMATCH_MARK_PARTIAL) {
+            std::string partial_path = local_path + kPartialFileSuffix;
+            if (::rename(local_path.c_str(), partial_path.c_str()) != 0) {
+                SDK_LOG_ERR("Rename incomplete file %s to %s fail",
+                            local_path.c_str(), partial_path.c_str());
+            }
+        }
+    }
+
     return result;
 }
 
@@ -89,30 +302,40 @@ CosResult ObjectOp::PutObject(const PutObjectByStreamReq& req, PutObjectByStream
     std::map<std::string, std::string> additional_params;
 
     std::istream& is = req.GetStream();
+    // 无法seek的流只能读一遍, 不能预先计算Content-MD5, 以chunked编码边读边发
+    bool is_seekable = (is.tellg() != std::streampos(-1));
 
     // 如果传递的header中没有Content-MD5则进行SDK进行MD5校验
     bool is_check_md5 = false;
     std::string md5_str = "";
-    if (req.GetHeader("Content-MD5").empty()) {
-        Poco::MD5Engine md5;
-        Poco::DigestOutputStream dos(md5);
-        std::streampos pos = is.tellg();
-        Poco::StreamCopier::copyStream(is, dos);
-        is.clear();
-        is.seekg(pos);
-        dos.close();
-        md5_str = Poco::DigestEngine::digestToHex(md5.digest());
+    if (req.GetHeader("Content-MD5").empty()
+        && (!req.ShouldComputeContentMd5() || !is_seekable)) {
+        // 边上传边计算MD5, 上传完成后用MD5校验ETag
+        Md5TeeInputStream md5_is(is);
+        result = UploadAction(host, path, req, additional_headers,
+                              additional_params, md5_is, resp);
+        md5_str = md5_is.GetMd5();
         is_check_md5 = true;
-        // 默认开启MD5校验
-        if (req.ShouldComputeContentMd5()) {
+    } else {
+        if (req.GetHeader("Content-MD5").empty()) {
+            Poco::MD5Engine md5;
+            Poco::DigestOutputStream dos(md5);
+            std::streampos pos = is.tellg();
+            Poco::StreamCopier::copyStream(is, dos);
+            is.clear();
+            is.seekg(pos);
+            dos.close();
+            md5_str = Poco::DigestEngine::digestToHex(md5.digest());
+            is_check_md5 = true;
+            // 默认开启MD5校验, Content-MD5头需要在发送body之前计算
             std::string bin_str = CodecUtil::HexToBin(md5_str);
             std::string encode_str = CodecUtil::Base64Encode(bin_str);
             additional_headers.insert(std::make_pair("Content-MD5",encode_str));
         }
-    }
 
-    result = UploadAction(host, path, req, additional_headers,
-                          additional_params, is, resp);
+        result = UploadAction(host, path, req, additional_headers,
+                              additional_params, is, resp);
+    }
 
     if (result.IsSucc() && is_check_md5 && md5_str != resp->GetEtag()) {
         result.SetFail();
@@ -142,26 +365,33 @@ CosResult ObjectOp::PutObject(const PutObjectByFileReq& req, PutObjectByFileResp
     // 如果传递的header中没有Content-MD5则进行SDK进行MD5校验
     bool is_check_md5 = false;
     std::string md5_str = "";
-    if (req.GetHeader("Content-MD5").empty()) {
-        Poco::MD5Engine md5;
-        Poco::DigestOutputStream dos(md5);
-        std::streampos pos = ifs.tellg();
-        Poco::StreamCopier::copyStream(ifs, dos);
-        ifs.clear();
-        ifs.seekg(pos);
-        dos.close();
-        md5_str = Poco::DigestEngine::digestToHex(md5.digest());
+    if (req.GetHeader("Content-MD5").empty() && req.IsComputeMd5DuringUpload()) {
+        // 边上传边计算MD5, 文件只读一次, 上传完成后用MD5校验ETag
+        Md5TeeInputStream md5_is(ifs);
+        result = UploadAction(host, path, req, additional_headers,
+                              additional_params, md5_is, resp);
+        md5_str = md5_is.GetMd5();
         is_check_md5 = true;
-        // 默认开启MD5校验
-        if (req.ShouldComputeContentMd5()) {
+    } else {
+        if (req.GetHeader("Content-MD5").empty()) {
+            Poco::MD5Engine md5;
+            Poco::DigestOutputStream dos(md5);
+            std::streampos pos = ifs.tellg();
+            Poco::StreamCopier::copyStream(ifs, dos);
+            ifs.clear();
+            ifs.seekg(pos);
+            dos.close();
+            md5_str = Poco::DigestEngine::digestToHex(md5.digest());
+            is_check_md5 = true;
+            // 默认开启MD5校验, Content-MD5头需要在发送body之前计算
             std::string bin_str = CodecUtil::HexToBin(md5_str);
             std::string encode_str = CodecUtil::Base64Encode(bin_str);
             additional_headers.insert(std::make_pair("Content-MD5",encode_str));
         }
-    }
 
-    result = UploadAction(host, path, req, additional_headers,
-                          additional_params, ifs, resp);
+        result = UploadAction(host, path, req, additional_headers,
+                              additional_params, ifs, resp);
+    }
     if (result.IsSucc() && is_check_md5 && md5_str != resp->GetEtag()) {
         result.SetFail();
         result.SetErrorInfo("Response etag is not correct, Please try again.");
@@ -197,17 +427,35 @@ CosResult ObjectOp::DeleteObjects(const DeleteObjectsReq& req, DeleteObjectsResp
     std::string path = req.GetPath();
     std::map<std::string, std::string> additional_headers;
     std::map<std::string, std::string> additional_params;
-    if (!req.GenerateRequestBody(&req_body)) {
+    if (!BuildDeleteObjectsBody(req, &req_body, &additional_headers)) {
         result.SetErrorInfo("Generate DeleteObjects Request Body fail.");
         return result;
     }
-    std::string raw_md5 = CodecUtil::Base64Encode(CodecUtil::RawMd5(req_body));
-    additional_headers.insert(std::make_pair("Content-MD5", raw_md5));
 
     return NormalAction(host, path, req, additional_headers,
                         additional_params, req_body, false, resp);
 }
 
+void ObjectOp::DeleteObjectsAsync(const DeleteObjectsReq& req, DeleteObjectsResp* resp,
+                                  const AsyncCallback& callback) {
+    std::string host = CosSysConfig::GetHost(GetAppId(), m_config->GetRegion(),
+                                             req.GetBucketName());
+
+    std::string req_body = "";
+    std::string path = req.GetPath();
+    std::map<std::string, std::string> additional_headers;
+    std::map<std::string, std::string> additional_params;
+    if (!BuildDeleteObjectsBody(req, &req_body, &additional_headers)) {
+        CosResult result;
+        result.SetErrorInfo("Generate DeleteObjects Request Body fail.");
+        callback(result);
+        return;
+    }
+
+    NormalActionAsync(host, path, req, additional_headers, additional_params, req_body,
+                      false, resp, callback);
+}
+
 CosResult ObjectOp::MultiUploadObject(const MultiUploadObjectReq& req,
                                       MultiUploadObjectResp* resp) {
     CosResult result;
@@ -222,44 +470,57 @@ CosResult ObjectOp::MultiUploadObject(const MultiUploadObjectReq& req,
         return result;
     }
 
-    // 1. Init
-    InitMultiUploadReq init_req(bucket_name, object_name);
-    const std::string& server_side_encryption = req.GetHeader("x-cos-server-side-encryption");
-    if (!server_side_encryption.empty()) {
-        init_req.SetXCosServerSideEncryption(server_side_encryption);
+    // 断点续传模式下先尝试恢复上次未完成的上传
+    const std::string& checkpoint_file = req.GetCheckpointFile();
+    bool is_resumable = !checkpoint_file.empty();
+    UploadCheckpoint checkpoint;
+    std::string upload_id = "";
+    if (is_resumable && LoadUploadCheckpoint(req, &checkpoint)) {
+        upload_id = checkpoint.GetUploadId();
+        SDK_LOG_INFO("Resume multi upload, upload_id=%s, uploaded parts=%lu",
+                     upload_id.c_str(), checkpoint.GetParts().size());
     }
 
-    if (req.IsSetXCosMeta()) {
-        const std::map<std::string, std::string> xcos_meta = req.GetXCosMeta();
-        std::map<std::string, std::string>::const_iterator iter = xcos_meta.begin();  
-        for(; iter != xcos_meta.end(); iter++) {
-            init_req.SetXCosMeta(iter->first, iter->second);
+    if (upload_id.empty()) {
+        // 1. Init, 非断点续传或无法续传时新建分块上传
+        InitMultiUploadReq init_req(bucket_name, object_name);
+        FillInitMultiUploadReq(req, &init_req);
+        InitMultiUploadResp init_resp;
+        result = InitMultiUpload(init_req, &init_resp);
+        if (!result.IsSucc()) {
+            SDK_LOG_ERR("Multi upload object fail, check init mutli result.");
+            resp->CopyFrom(init_resp);
+            return result;
+        }
+        upload_id = init_resp.GetUploadId();
+        if (upload_id.empty()) {
+            SDK_LOG_ERR("Multi upload object fail, upload id is empty.");
+            resp->CopyFrom(init_resp);
+            return result;
         }
-    }
 
-    InitMultiUploadResp init_resp;
-    init_req.SetConnTimeoutInms(req.GetConnTimeoutInms());
-    init_req.SetRecvTimeoutInms(req.GetRecvTimeoutInms());
-    result = InitMultiUpload(init_req, &init_resp);
-    if (!result.IsSucc()) {
-        SDK_LOG_ERR("Multi upload object fail, check init mutli result.");
-        resp->CopyFrom(init_resp);
-        return result;
-    }
-    std::string upload_id = init_resp.GetUploadId();
-    if (upload_id.empty()) {
-        SDK_LOG_ERR("Multi upload object fail, upload id is empty.");
-        resp->CopyFrom(init_resp);
-        return result;
+        if (is_resumable) {
+            checkpoint.SetUploadId(upload_id);
+            checkpoint.Save(checkpoint_file);
+        }
     }
 
     // 2. Multi Upload
     std::vector<std::string> etags;
     std::vector<uint64_t> part_numbers;
+    std::string crc64_str = "";
     // TODO(返回值判断)
-    result = MultiThreadUpload(req, upload_id, &etags, &part_numbers);
+    result = MultiThreadUpload(req, upload_id, is_resumable ? &checkpoint : NULL,
+                               &etags, &part_numbers, &crc64_str);
     if (!result.IsSucc()) {
         SDK_LOG_ERR("Multi upload object fail, check upload mutli result.");
+        // 断点续传时保留已上传的分块, 下次上传时继续
+        if (is_resumable) {
+            SDK_LOG_INFO("Multi upload object interrupted, upload_id=%s, checkpoint_file=%s",
+                         upload_id.c_str(), checkpoint_file.c_str());
+            return result;
+        }
+
         // Copy失败则需要Abort
         AbortMultiUploadReq abort_req(req.GetBucketName(),
                 req.GetObjectName(), upload_id);
@@ -285,9 +546,328 @@ CosResult ObjectOp::MultiUploadObject(const MultiUploadObjectReq& req,
     result = CompleteMultiUpload(comp_req, &comp_resp);
     resp->CopyFrom(comp_resp);
 
+    // 分块的ETag不是整个对象的MD5, 用各分块CRC64合并的结果校验整个对象
+    const std::string& resp_crc64 = comp_resp.GetHeader(kHttpHeaderXCosHashCrc64Ecma);
+    if (result.IsSucc() && CosSysConfig::IsCheckCrc64()
+        && !resp_crc64.empty() && resp_crc64 != crc64_str) {
+        result.SetFail();
+        result.SetErrorInfo("Response crc64 is not correct, Please try again.");
+        SDK_LOG_ERR("Response crc64 is not correct. Expect crc64 is %s, but return crc64 is %s."
+                    " RequestId=%s", crc64_str.c_str(), resp_crc64.c_str(),
+                    comp_resp.GetXCosRequestId().c_str());
+    }
+
+    if (result.IsSucc() && is_resumable) {
+        UploadCheckpoint::Remove(checkpoint_file);
+    }
+
+    return result;
+}
+
+CosResult ObjectOp::MultiUploadObject(const MultiUploadObjectByStreamReq& req,
+                                      MultiUploadObjectResp* resp) {
+    CosResult result;
+    std::string bucket_name = req.GetBucketName();
+    std::string object_name = req.GetObjectName();
+    std::string path = "/" + object_name;
+    std::string host = CosSysConfig::GetHost(GetAppId(), m_config->GetRegion(), bucket_name);
+    std::string dest_url = GetRealUrl(host, path, req.IsHttps());
+    std::istream& is = req.GetStream();
+
+    // 上传中的分块各占一个buffer, 多出的一个用于读取下一个分块, 最多(pool_size + 1)个buffer,
+    // 全局buffer额度不足时减少buffer数
+    uint64_t part_size = req.GetPartSize();
+    int pool_size = req.GetThreadPoolSize();
+    unsigned char** part_buf = new unsigned char*[pool_size + 1];
+    int buf_num = AcquirePartBuffers(part_size, pool_size + 1, part_buf);
+    if (buf_num == 0) {
+        delete [] part_buf;
+        result.SetErrorInfo("Allocate part buffer fail.");
+        return result;
+    }
+    FileUploadTask** pptaskArr = new FileUploadTask*[buf_num];
+    for (int i = 0; i < buf_num; ++i) {
+        pptaskArr[i] = new FileUploadTask(dest_url, req.GetConnTimeoutInms(),
+                                          req.GetRecvTimeoutInms());
+    }
+    std::vector<uint64_t> task_part_numbers(buf_num, 0);
+    std::map<uint64_t, std::string> part_etags;
+    std::map<uint64_t, uint64_t> part_crc64s;
+
+    // 1. 先读满第一个分块, 流在此结束时直接PutObject, 不需要Init
+    is.read(reinterpret_cast<char*>(part_buf[0]), part_size);
+    size_t read_len = is.gcount();
+    bool is_single_put = (read_len < part_size
+                          || is.peek() == std::char_traits<char>::eof());
+    std::string upload_id = "";
+    if (is.bad()) {
+        result.SetErrorInfo("Read upload stream fail.");
+    } else if (is_single_put) {
+        std::map<std::string, std::string> headers = req.GetHeaders();
+        const std::map<std::string, std::string> xcos_meta = req.GetXCosMeta();
+        std::map<std::string, std::string>::const_iterator iter = xcos_meta.begin();
+        for (; iter != xcos_meta.end(); ++iter) {
+            headers["x-cos-meta-" + iter->first] = iter->second;
+        }
+        if (!CosSysConfig::IsDomainSameToHost()) {
+            headers["Host"] = host;
+        } else {
+            headers["Host"] = CosSysConfig::GetDestDomain();
+        }
+        std::map<std::string, std::string> params;
+        headers["Authorization"] = AuthTool::Sign(GetAccessKey(), GetSecretKey(), "PUT",
+                                                  path, headers, params);
+        const std::string& tmp_token = m_config->GetTmpToken();
+        if (!tmp_token.empty()) {
+            headers["x-cos-security-token"] = tmp_token;
+        }
+
+        FileUploadTask* ptask = pptaskArr[0];
+        ptask->SetHeaders(headers);
+        ptask->SetUploadBuf(part_buf[0], read_len);
+        ptask->Run();
+        if (CheckUploadTask(ptask, 1, &part_etags, &part_crc64s, &result)) {
+            result.SetSucc();
+            resp->ParseFromHeaders(ptask->GetRespHeaders());
+            result.SetXCosRequestId(resp->GetXCosRequestId());
+        }
+    } else {
+        // 2. Init
+        InitMultiUploadReq init_req(bucket_name, object_name);
+        FillInitMultiUploadReq(req, &init_req);
+        InitMultiUploadResp init_resp;
+        result = InitMultiUpload(init_req, &init_resp);
+        upload_id = init_resp.GetUploadId();
+        if (!result.IsSucc() || upload_id.empty()) {
+            SDK_LOG_ERR("Multi upload object fail, check init mutli result.");
+            resp->CopyFrom(init_resp);
+        }
+    }
+
+    if (!upload_id.empty()) {
+        // 3. 分块读满即派发, 没有空闲buffer时等待任一分块完成后复用其buffer
+        bool task_fail_flag = false;
+        uint64_t total_len = 0;
+        uint64_t part_number = 1;
+        int task_index = 0;
+        int running_task_num = 0;
+        TaskDoneQueue done_queue;
+        std::deque<int> free_tasks;
+        for (int i = 1; i < buf_num; ++i) {
+            free_tasks.push_back(i);
+        }
+
+        // 分块提交到进程共享的线程池, 退出前必须Pop回所有已派发的分块, done_queue才能析构
+        TransferExecutor& executor = TransferExecutor::Instance();
+        while (read_len > 0) {
+            // 流的长度事先未知, 超出分块数上限时立即失败, 不再读取和上传剩余的数据
+            if (part_number > kMaxPartNum) {
+                std::string err_info = "Upload stream exceeds "
+                    + StringUtil::Uint64ToString(kMaxPartNum) + " parts of "
+                    + StringUtil::Uint64ToString(part_size) + " bytes, increase the part size.";
+                SDK_LOG_ERR("%s", err_info.c_str());
+                result.SetFail();
+                result.SetErrorInfo(err_info);
+                task_fail_flag = true;
+                break;
+            }
+
+            FileUploadTask* ptask = pptaskArr[task_index];
+            FillUploadTask(upload_id, host, path, part_buf[task_index], read_len,
+                           part_number, ptask);
+            task_part_numbers[task_index] = part_number;
+            executor.Schedule(boost::bind(&RunTaskAndNotify<FileUploadTask>, ptask,
+                                          task_index, &done_queue));
+            ++running_task_num;
+            total_len += read_len;
+            ++part_number;
+
+            if (!free_tasks.empty()) {
+                task_index = free_tasks.front();
+                free_tasks.pop_front();
+            } else {
+                task_index = done_queue.Pop();
+                --running_task_num;
+                if (!CheckUploadTask(pptaskArr[task_index], task_part_numbers[task_index],
+                                     &part_etags, &part_crc64s, &result)) {
+                    task_fail_flag = true;
+                    break;
+                }
+            }
+
+            is.read(reinterpret_cast<char*>(part_buf[task_index]), part_size);
+            read_len = is.gcount();
+            if (is.bad()) {
+                result.SetFail();
+                result.SetErrorInfo("Read upload stream fail.");
+                task_fail_flag = true;
+                break;
+            }
+        }
+
+        // 等待剩余的分块, 失败后不再派发新分块但仍需回收已派发的分块
+        while (running_task_num > 0) {
+            task_index = done_queue.Pop();
+            --running_task_num;
+            if (!task_fail_flag
+                && !CheckUploadTask(pptaskArr[task_index], task_part_numbers[task_index],
+                                    &part_etags, &part_crc64s, &result)) {
+                task_fail_flag = true;
+            }
+        }
+
+        if (task_fail_flag) {
+            SDK_LOG_ERR("Multi upload object fail, check upload mutli result.");
+            AbortMultiUploadReq abort_req(bucket_name, object_name, upload_id);
+            AbortMultiUploadResp abort_resp;
+            CosResult abort_result = AbortMultiUpload(abort_req, &abort_resp);
+            if (!abort_result.IsSucc()) {
+                SDK_LOG_ERR("Upload failed, and abort muliti upload also failed"
+                            ", upload_id=%s", upload_id.c_str());
+                result = abort_result;
+            }
+        } else {
+            // 4. Complete
+            std::vector<std::string> etags;
+            std::vector<uint64_t> part_numbers;
+            std::map<uint64_t, std::string>::const_iterator itr = part_etags.begin();
+            for (; itr != part_etags.end(); ++itr) {
+                part_numbers.push_back(itr->first);
+                etags.push_back(itr->second);
+            }
+
+            CompleteMultiUploadReq comp_req(bucket_name, object_name, upload_id);
+            CompleteMultiUploadResp comp_resp;
+            comp_req.SetConnTimeoutInms(req.GetConnTimeoutInms());
+            comp_req.SetRecvTimeoutInms(req.GetRecvTimeoutInms() * 2); // Complete的超时翻倍
+            comp_req.SetEtags(etags);
+            comp_req.SetPartNumbers(part_numbers);
+            result = CompleteMultiUpload(comp_req, &comp_resp);
+            resp->CopyFrom(comp_resp);
+
+            const std::string& crc64_str = CombinePartCrc64(part_crc64s, part_etags.size(),
+                                                            part_size, total_len);
+            const std::string& resp_crc64 = comp_resp.GetHeader(kHttpHeaderXCosHashCrc64Ecma);
+            if (result.IsSucc() && CosSysConfig::IsCheckCrc64()
+                && !resp_crc64.empty() && resp_crc64 != crc64_str) {
+                result.SetFail();
+                result.SetErrorInfo("Response crc64 is not correct, Please try again.");
+                SDK_LOG_ERR("Response crc64 is not correct. Expect crc64 is %s, but return"
+                            " crc64 is %s. RequestId=%s", crc64_str.c_str(), resp_crc64.c_str(),
+                            comp_resp.GetXCosRequestId().c_str());
+            }
+        }
+    }
+
+    for (int i = 0; i < buf_num; ++i) {
+        delete pptaskArr[i];
+    }
+    delete [] pptaskArr;
+    ReleasePartBuffers(part_size, buf_num, part_buf);
+    delete [] part_buf;
+
     return result;
 }
 
+bool ObjectOp::LoadUploadCheckpoint(const MultiUploadObjectReq& req,
+                                    UploadCheckpoint* checkpoint) {
+    const std::string& local_file_path = req.GetLocalFilePath();
+    uint64_t file_size = FileUtil::GetFileLen(local_file_path);
+    uint64_t part_size = req.GetPartSize();
+    checkpoint->SetBucketName(req.GetBucketName());
+    checkpoint->SetObjectName(req.GetObjectName());
+    checkpoint->SetPartSize(part_size);
+    checkpoint->SetFileSize(file_size);
+    checkpoint->SetFileMtime(FileUtil::GetFileMtime(local_file_path));
+    if (req.IsCheckpointVerifyFileMd5()) {
+        checkpoint->SetFileMd5(FileUtil::GetFileMd5(local_file_path));
+    }
+
+    UploadCheckpoint saved;
+    if (!saved.Load(req.GetCheckpointFile())) {
+        return false;
+    }
+
+    if (saved.GetUploadId().empty()) {
+        return false;
+    }
+
+    if (!saved.IsSameUpload(*checkpoint)) {
+        SDK_LOG_INFO("Upload checkpoint mismatch, start a new upload, checkpoint_file=%s",
+                     req.GetCheckpointFile().c_str());
+        // 本地文件已变化, 旧的分块不再可用, 尽力清理
+        if (saved.GetBucketName() == req.GetBucketName()
+            && saved.GetObjectName() == req.GetObjectName()) {
+            AbortMultiUploadReq abort_req(req.GetBucketName(), req.GetObjectName(),
+                                          saved.GetUploadId());
+            AbortMultiUploadResp abort_resp;
+            AbortMultiUpload(abort_req, &abort_resp);
+        }
+        return false;
+    }
+
+    // 以服务端ListParts的结果为准, 只保留大小正确的分块;
+    // checkpoint中没有记录(因此没有CRC64)或etag与服务端不一致的分块重新上传,
+    // 保证续传完成后可以校验整个对象的CRC64
+    uint64_t part_count = file_size == 0 ? 0 : (file_size + part_size - 1) / part_size;
+    const std::map<uint64_t, std::string>& saved_parts = saved.GetParts();
+    const std::map<uint64_t, uint64_t>& saved_crc64s = saved.GetPartCrc64s();
+    std::map<uint64_t, std::string> parts;
+    std::map<uint64_t, uint64_t> part_crc64s;
+    std::string part_number_marker = "";
+    while (true) {
+        ListPartsReq list_req(req.GetBucketName(), req.GetObjectName(), saved.GetUploadId());
+        list_req.SetConnTimeoutInms(req.GetConnTimeoutInms());
+        list_req.SetRecvTimeoutInms(req.GetRecvTimeoutInms());
+        if (!part_number_marker.empty()) {
+            list_req.SetPartNumberMarker(part_number_marker);
+        }
+
+        ListPartsResp list_resp;
+        CosResult result = ListParts(list_req, &list_resp);
+        if (!result.IsSucc()) {
+            SDK_LOG_WARN("List parts of upload_id=%s fail, start a new upload.",
+                         saved.GetUploadId().c_str());
+            return false;
+        }
+
+        const std::vector<Part>& list_parts = list_resp.GetParts();
+        for (std::vector<Part>::const_iterator itr = list_parts.begin();
+             itr != list_parts.end(); ++itr) {
+            if (itr->m_part_num == 0 || itr->m_part_num > part_count) {
+                continue;
+            }
+
+            uint64_t expect_size = itr->m_part_num < part_count ? part_size
+                : file_size - (part_count - 1) * part_size;
+            if (itr->m_size != expect_size) {
+                continue;
+            }
+
+            std::map<uint64_t, std::string>::const_iterator saved_itr
+                = saved_parts.find(itr->m_part_num);
+            std::map<uint64_t, uint64_t>::const_iterator crc_itr
+                = saved_crc64s.find(itr->m_part_num);
+            if (saved_itr == saved_parts.end() || crc_itr == saved_crc64s.end()
+                || StringUtil::Trim(saved_itr->second, "\"")
+                   != StringUtil::Trim(itr->m_etag, "\"")) {
+                continue;
+            }
+            parts[itr->m_part_num] = itr->m_etag;
+            part_crc64s[itr->m_part_num] = crc_itr->second;
+        }
+
+        if (!list_resp.IsTruncated()) {
+            break;
+        }
+        part_number_marker = StringUtil::Uint64ToString(list_resp.GetNextPartNumberMarker());
+    }
+
+    checkpoint->SetUploadId(saved.GetUploadId());
+    checkpoint->SetParts(parts, part_crc64s);
+    return true;
+}
+
 CosResult ObjectOp::InitMultiUpload(const InitMultiUploadReq& req, InitMultiUploadResp* resp) {
     std::string host = CosSysConfig::GetHost(GetAppId(), m_config->GetRegion(),
                                              req.GetBucketName());
@@ -558,7 +1138,6 @@ CosResult ObjectOp::Copy(const CopyReq& req, CopyResp* resp) {
             pool_size = max_task_num;
         }
 
-        boost::threadpool::pool tp(pool_size);
         std::string path = "/" + req.GetObjectName();
         std::string host = CosSysConfig::GetHost(GetAppId(), m_config->GetRegion(), req.GetBucketName());
         std::string dest_url = GetRealUrl(host, path, req.IsHttps());
@@ -567,6 +1146,7 @@ CosResult ObjectOp::Copy(const CopyReq& req, CopyResp* resp) {
             pptaskArr[i] = new FileCopyTask(dest_url, req.GetConnTimeoutInms(), req.GetRecvTimeoutInms());
         }
 
+        TransferTaskGroup task_group;
         while (offset < file_size) {
             unsigned task_index = 0;
             for (; task_index < pool_size && offset < file_size; ++task_index) {
@@ -583,14 +1163,14 @@ CosResult ObjectOp::Copy(const CopyReq& req, CopyResp* resp) {
                 FillCopyTask(upload_id, host, path, part_number, range,
                              part_copy_headers, req.GetParams(), ptask);
 
-                tp.schedule(boost::bind(&FileCopyTask::Run, ptask));
+                task_group.Schedule(boost::bind(&FileCopyTask::Run, ptask));
                 part_numbers.push_back(part_number);
                 ++part_number;
                 offset = end + 1;
             }
 
             unsigned task_num = task_index;
-            tp.wait();
+            task_group.Wait();
 
             for (task_index = 0; task_index < task_num; ++task_index) {
                 FileCopyTask* ptask = pptaskArr[task_index];
@@ -711,6 +1291,31 @@ CosResult ObjectOp::MultiThreadDownload(const MultiGetObjectReq& req, MultiGetOb
         headers["x-cos-security-token"] = tmp_token;
     }
 
+    uint64_t file_size = head_resp.GetContentLength();
+    std::string local_path = req.GetLocalFilePath();
+
+    // 断点续传: checkpoint与当前对象一致时保留已下载的内容, 只下载缺失的分片;
+    // 分片请求带If-Match, 对象在下载过程中被修改时返回412
+    const std::string& checkpoint_file = req.GetCheckpointFile();
+    bool is_resumable = !checkpoint_file.empty() && !head_resp.GetEtag().empty();
+    bool is_resume = false;
+    DownloadCheckpoint checkpoint;
+    if (is_resumable) {
+        // HeadObjectResp中的etag已去掉引号, If-Match需要带引号的entity-tag
+        headers["If-Match"] = "\"" + head_resp.GetEtag() + "\"";
+        checkpoint.Reset(req.GetBucketName(), req.GetObjectName(), head_resp.GetEtag(),
+                         file_size, req.GetSliceSize());
+
+        DownloadCheckpoint saved;
+        if (saved.Load(checkpoint_file) && saved.IsSameDownload(checkpoint)
+            && access(local_path.c_str(), F_OK) == 0) {
+            checkpoint = saved;
+            is_resume = true;
+            SDK_LOG_INFO("Resume download, local_file=%s, downloaded slices=%lu",
+                         local_path.c_str(), checkpoint.GetDoneSliceNum());
+        }
+    }
+
     std::string auth_str = AuthTool::Sign(GetAccessKey(), GetSecretKey(),
                                           req.GetMethod(), path, headers, params);
     if (auth_str.empty()) {
@@ -719,11 +1324,9 @@ CosResult ObjectOp::MultiThreadDownload(const MultiGetObjectReq& req, MultiGetOb
     }
     headers["Authorization"] = auth_str;
 
-    uint64_t file_size = head_resp.GetContentLength();
-
-    // 3. 打开本地文件
-    std::string local_path = req.GetLocalFilePath();
-    int fd = open(local_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+    // 3. 打开本地文件, 续传时不能清空已下载的内容
+    int open_flags = is_resume ? (O_WRONLY | O_CREAT) : (O_WRONLY | O_CREAT | O_TRUNC);
+    int fd = open(local_path.c_str(), open_flags,
                   S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
     if (-1 == fd) {
         std::string err_info = "open file(" + local_path + ") fail, errno="
@@ -733,7 +1336,11 @@ CosResult ObjectOp::MultiThreadDownload(const MultiGetObjectReq& req, MultiGetOb
         return result;
     }
 
-    // 4. 多线程下载
+    if (is_resumable && !is_resume) {
+        checkpoint.Save(checkpoint_file);
+    }
+
+    // 4. 多线程下载, 每个线程循环领取下一个分片, 下载完直接pwrite到文件对应偏移
     unsigned pool_size = req.GetThreadPoolSize();
     unsigned slice_size = req.GetSliceSize();
     unsigned max_task_num = file_size / slice_size + 1;
@@ -741,11 +1348,6 @@ CosResult ObjectOp::MultiThreadDownload(const MultiGetObjectReq& req, MultiGetOb
         pool_size = max_task_num;
     }
 
-    unsigned char** file_content_buf = new unsigned char* [pool_size];
-    for(unsigned i = 0; i < pool_size; ++i) {
-        file_content_buf[i] = new unsigned char[slice_size];
-    }
-
     std::string dest_url = GetRealUrl(host, path, req.IsHttps());
     FileDownTask** pptaskArr = new FileDownTask*[pool_size];
     for (unsigned i = 0; i < pool_size; ++i) {
@@ -756,85 +1358,67 @@ CosResult ObjectOp::MultiThreadDownload(const MultiGetObjectReq& req, MultiGetOb
     SDK_LOG_DBG("download data,url=%s, poolsize=%u,slice_size=%u,file_size=%lu",
                 dest_url.c_str(), pool_size, slice_size, file_size);
 
-    std::vector<uint64_t> vec_offset;
-    vec_offset.resize(pool_size);
-    boost::threadpool::pool tp(pool_size);
-    uint64_t offset =0;
-    bool task_fail_flag = false;
-    unsigned down_times = 0;
-    bool is_header_set = false;
-    while(offset < file_size) {
-        SDK_LOG_DBG("down data, offset=%lu, file_size=%lu", offset, file_size);
-        unsigned task_index = 0;
-        vec_offset.clear();
-        for (; task_index < pool_size && (offset < file_size); ++task_index) {
-            SDK_LOG_DBG("down data, task_index=%d, file_size=%lu, offset=%lu",
-                        task_index, file_size, offset);
-            FileDownTask* ptask = pptaskArr[task_index];
-
-            ptask->SetDownParams(file_content_buf[task_index], slice_size, offset);
-            tp.schedule(boost::bind(&FileDownTask::Run, ptask));
-            vec_offset[task_index] = offset;
-            offset += slice_size;
-            ++down_times;
+    FileDownSliceQueue slice_queue(file_size, slice_size, fd,
+                                   is_resumable ? &checkpoint : NULL, checkpoint_file);
+    {
+        TransferTaskGroup task_group;
+        for (unsigned task_index = 0; task_index < pool_size; ++task_index) {
+            task_group.Schedule(boost::bind(&FileDownTask::Run, pptaskArr[task_index],
+                                            &slice_queue, fd));
         }
+        task_group.Wait();
+    }
+    // 记录最后一批分片, 下载失败时下次可以从这里继续
+    slice_queue.Flush();
 
-        unsigned task_num = task_index;
-
-        tp.wait();
-
-        for (task_index = 0; task_index < task_num; ++task_index) {
-            FileDownTask *ptask = pptaskArr[task_index];
-            if (!ptask->IsTaskSuccess()) {
-                const std::string& task_resp = ptask->GetTaskResp();
-                const std::map<std::string, std::string>& task_resp_headers
-                    = ptask->GetRespHeaders();
-                SDK_LOG_ERR("down data, down task fail, rsp:%s", task_resp.c_str());
-                result.SetHttpStatus(ptask->GetHttpStatus());
-                if (ptask->GetHttpStatus() == -1) {
-                    result.SetErrorInfo(ptask->GetErrMsg());
-                } else if (!result.ParseFromHttpResponse(task_resp_headers, task_resp)) {
-                    result.SetErrorInfo(task_resp);
-                }
-                resp->ParseFromHeaders(ptask->GetRespHeaders());
+    bool task_fail_flag = false;
+    bool is_header_set = false;
+    for (unsigned task_index = 0; task_index < pool_size; ++task_index) {
+        FileDownTask *ptask = pptaskArr[task_index];
+        if (!ptask->IsTaskSuccess()) {
+            const std::string& task_resp = ptask->GetTaskResp();
+            const std::map<std::string, std::string>& task_resp_headers
+                = ptask->GetRespHeaders();
+            SDK_LOG_ERR("down data, down task fail, rsp:%s", task_resp.c_str());
+            result.SetHttpStatus(ptask->GetHttpStatus());
+            if (ptask->GetHttpStatus() == -1) {
+                result.SetErrorInfo(ptask->GetErrMsg());
+            } else if (!result.ParseFromHttpResponse(task_resp_headers, task_resp)) {
+                result.SetErrorInfo(task_resp);
+            }
+            resp->ParseFromHeaders(task_resp_headers);
 
-                task_fail_flag = true;
-                break;
-            } else {
-                if (-1 == lseek(fd, vec_offset[task_index], SEEK_SET)) {
-                    std::string err_info = "down data, lseek ret="
-                        + StringUtil::IntToString(errno) + ", offset="
-                        + StringUtil::Uint64ToString(vec_offset[task_index]);
-                    SDK_LOG_ERR("%s", err_info.c_str());
-                    result.SetErrorInfo(err_info);
-                    task_fail_flag = true;
-                    break;
-                }
+            // 对象已被修改, 已下载的分片不再可用
+            if (is_resumable && ptask->GetHttpStatus() == 412) {
+                DownloadCheckpoint::Remove(checkpoint_file);
+            }
 
-                if (-1 == write(fd, file_content_buf[task_index], ptask->GetDownLoadLen())) {
-                    std::string err_info = "down data, write ret="
-                        + StringUtil::IntToString(errno) + ", len="
-                        + StringUtil::Uint64ToString(ptask->GetDownLoadLen());
-                    SDK_LOG_ERR("%s", err_info.c_str());
-                    result.SetErrorInfo(err_info);
-                    task_fail_flag = true;
-                    break;
-                }
+            task_fail_flag = true;
+            break;
+        }
 
-                if (!is_header_set) {
-                    resp->ParseFromHeaders(ptask->GetRespHeaders());
-                    is_header_set = true;
-                }
-                SDK_LOG_DBG("down data, down_times=%u,task_index=%d, file_size=%lu, "
-                            "offset=%lu, downlen:%lu ",
-                            down_times,task_index, file_size,
-                            vec_offset[task_index], ptask->GetDownLoadLen());
-            }
+        if (!is_header_set && !ptask->GetRespHeaders().empty()) {
+            resp->ParseFromHeaders(ptask->GetRespHeaders());
+            is_header_set = true;
         }
+    }
 
-        if (task_fail_flag) {
-            break;
+    // 各分片的CRC64在接收时已算出(续传前的分片取自checkpoint), 合并后与head返回的
+    // 整个对象的CRC64比较
+    uint64_t crc64 = 0;
+    const std::string& expect_crc64 = head_resp.GetHeader(kHttpHeaderXCosHashCrc64Ecma);
+    if (!task_fail_flag && CosSysConfig::IsCheckCrc64() && !expect_crc64.empty()
+        && (!slice_queue.GetCrc64(&crc64) || StringUtil::Uint64ToString(crc64) != expect_crc64)) {
+        std::string err_info = "Download file crc64 is not correct, expect crc64 is "
+            + expect_crc64 + ", but local crc64 is " + StringUtil::Uint64ToString(crc64);
+        SDK_LOG_ERR("%s", err_info.c_str());
+        result.SetFail();
+        result.SetErrorInfo(err_info);
+        // 已下载的内容不可信, 下次需要重新下载
+        if (is_resumable) {
+            DownloadCheckpoint::Remove(checkpoint_file);
         }
+        task_fail_flag = true;
     }
 
     if (!task_fail_flag) {
@@ -842,18 +1426,17 @@ CosResult ObjectOp::MultiThreadDownload(const MultiGetObjectReq& req, MultiGetOb
         // 下载成功则用head得到的content_length和etag设置get response
         resp->SetContentLength(file_size);
         resp->SetEtag(head_resp.GetEtag());
+        if (is_resumable) {
+            DownloadCheckpoint::Remove(checkpoint_file);
+        }
     }
 
     // 4. 释放所有资源
     close(fd);
     for(unsigned i = 0; i < pool_size; i++){
-        delete [] file_content_buf[i];
         delete pptaskArr[i];
     }
     delete [] pptaskArr;
-    delete [] file_content_buf;
-
-    uint64_t file_len = offset > file_size ? file_size : offset;
 
     return result;
 }
@@ -861,8 +1444,10 @@ CosResult ObjectOp::MultiThreadDownload(const MultiGetObjectReq& req, MultiGetOb
 // TODO(sevenyou) 多线程上传, 返回的resp内容需要再斟酌下.
 CosResult ObjectOp::MultiThreadUpload(const MultiUploadObjectReq& req,
                                       const std::string& upload_id,
+                                      UploadCheckpoint* checkpoint,
                                       std::vector<std::string>* etags_ptr,
-                                      std::vector<uint64_t>* part_numbers_ptr) {
+                                      std::vector<uint64_t>* part_numbers_ptr,
+                                      std::string* crc64_ptr) {
     CosResult result;
     std::string path = "/" + req.GetObjectName();
     std::string host = CosSysConfig::GetHost(GetAppId(), m_config->GetRegion(),
@@ -884,102 +1469,129 @@ CosResult ObjectOp::MultiThreadUpload(const MultiUploadObjectReq& req,
 
     uint64_t part_size = req.GetPartSize();
     int pool_size = req.GetThreadPoolSize();
-    unsigned char** file_content_buf = new unsigned char*[pool_size];
-    for(int i = 0; i < pool_size; ++i) {
-        file_content_buf[i] = new unsigned char[part_size];
+    // 比线程数多一个buffer, 所有线程都在发送时主线程可以提前读取下一个分片.
+    // 全局buffer额度不足时减少buffer数
+    unsigned char** file_content_buf = new unsigned char*[pool_size + 1];
+    int buf_num = AcquirePartBuffers(part_size, pool_size + 1, file_content_buf);
+    if (buf_num == 0) {
+        delete [] file_content_buf;
+        result.SetErrorInfo("Allocate part buffer fail.");
+        return result;
     }
 
     std::string dest_url = GetRealUrl(host, path, req.IsHttps());
-    FileUploadTask** pptaskArr = new FileUploadTask*[pool_size];
-    for (int i = 0; i < pool_size; ++i) {
+    FileUploadTask** pptaskArr = new FileUploadTask*[buf_num];
+    for (int i = 0; i < buf_num; ++i) {
         pptaskArr[i] = new FileUploadTask(dest_url, req.GetConnTimeoutInms(), req.GetRecvTimeoutInms());
     }
+    std::vector<uint64_t> task_part_numbers(buf_num, 0);
 
     SDK_LOG_DBG("upload data,url=%s, poolsize=%u, part_size=%lu, file_size=%lu",
                 dest_url.c_str(), pool_size, part_size, file_size);
 
-    boost::threadpool::pool tp(pool_size);
+    // 分片完成的顺序和派发顺序无关, 按分片号记录etag, 最后按序交给Complete
+    std::map<uint64_t, std::string> part_etags;
+    std::map<uint64_t, uint64_t> part_crc64s;
+    if (checkpoint != NULL) {
+        part_etags = checkpoint->GetParts();
+        part_crc64s = checkpoint->GetPartCrc64s();
+    }
+    TaskDoneQueue done_queue;
+    std::deque<int> free_tasks;
+    for (int i = 0; i < buf_num; ++i) {
+        free_tasks.push_back(i);
+    }
+    int running_task_num = 0;
+
+    // 分片提交到进程共享的线程池, 退出前必须Pop回所有已派发的分片, done_queue才能析构
+    TransferExecutor& executor = TransferExecutor::Instance();
 
-    // 3. 多线程upload
+    // 3. 多线程upload, 任一分片完成后立即复用其buffer读取并派发下一个分片
     {
         uint64_t part_number = 1;
         while (offset < file_size) {
-            int task_index = 0;
-            for (; task_index < pool_size; ++task_index) {
-                fin.read((char *)file_content_buf[task_index], part_size);
-                size_t read_len = fin.gcount();
-                if (read_len == 0 && fin.eof()) {
-                    SDK_LOG_DBG("read over, task_index: %d", task_index);
-                    break;
-                }
-
-                SDK_LOG_DBG("upload data, task_index=%d, file_size=%lu, offset=%lu, len=%lu",
-                            task_index, file_size, offset, read_len);
-
-                FileUploadTask* ptask = pptaskArr[task_index];
-                FillUploadTask(upload_id, host, path, file_content_buf[task_index], read_len,
-                               part_number, ptask);
-                tp.schedule(boost::bind(&FileUploadTask::Run, ptask));
-                offset += read_len;
-                part_numbers_ptr->push_back(part_number);
+            // 断点续传时跳过已经上传成功的分块
+            if (checkpoint != NULL && checkpoint->HasPart(part_number)) {
+                uint64_t skip_len = std::min(part_size, file_size - offset);
+                fin.seekg(skip_len, std::ios::cur);
+                offset += skip_len;
                 ++part_number;
+                continue;
             }
 
-            int max_task_num = task_index;
-
-            tp.wait();
-            for (task_index = 0; task_index < max_task_num; ++task_index) {
-                FileUploadTask* ptask = pptaskArr[task_index];
-                if (!ptask->IsTaskSuccess()) {
-                    const std::string& task_resp = ptask->GetTaskResp();
-                    const std::map<std::string, std::string>& task_resp_headers = ptask->GetRespHeaders();
-                    SDK_LOG_ERR("upload data, upload task fail, rsp:%s", task_resp.c_str());
-                    result.SetHttpStatus(ptask->GetHttpStatus());
-                    if (ptask->GetHttpStatus() == -1) {
-                        result.SetErrorInfo(ptask->GetErrMsg());
-                    } else if (!result.ParseFromHttpResponse(task_resp_headers, task_resp)) {
-                        result.SetErrorInfo(task_resp);
-                    }
-
+            int task_index = 0;
+            if (!free_tasks.empty()) {
+                task_index = free_tasks.front();
+                free_tasks.pop_front();
+            } else {
+                task_index = done_queue.Pop();
+                --running_task_num;
+                if (!CheckUploadTask(pptaskArr[task_index], task_part_numbers[task_index],
+                                     &part_etags, &part_crc64s, &result)) {
                     task_fail_flag = true;
                     break;
                 }
+                SaveUploadCheckpoint(checkpoint, req.GetCheckpointFile(),
+                                     task_part_numbers[task_index], part_etags, part_crc64s);
+            }
 
-                // 找不到etag也算失败
-                const std::map<std::string, std::string>& resp_header = ptask->GetRespHeaders();
-                std::map<std::string, std::string>::const_iterator itr = resp_header.find("ETag");
-                if (itr != resp_header.end()) {
-                    etags_ptr->push_back(itr->second);
-                } else {
-                    std::string err_info = "upload data, upload task succ, "
-                        "but response header missing etag field.";
-                    SDK_LOG_ERR("%s", err_info.c_str());
-                    result.SetHttpStatus(ptask->GetHttpStatus());
-                    task_fail_flag = true;
-                    break;
-                }
+            fin.read((char *)file_content_buf[task_index], part_size);
+            size_t read_len = fin.gcount();
+            if (read_len == 0 && fin.eof()) {
+                SDK_LOG_DBG("read over, task_index: %d", task_index);
+                break;
             }
 
+            SDK_LOG_DBG("upload data, task_index=%d, file_size=%lu, offset=%lu, len=%lu",
+                        task_index, file_size, offset, read_len);
+
+            FileUploadTask* ptask = pptaskArr[task_index];
+            FillUploadTask(upload_id, host, path, file_content_buf[task_index], read_len,
+                           part_number, ptask);
+            task_part_numbers[task_index] = part_number;
+            executor.Schedule(boost::bind(&RunTaskAndNotify<FileUploadTask>, ptask,
+                                          task_index, &done_queue));
+            ++running_task_num;
+            offset += read_len;
+            ++part_number;
+        }
+
+        // 等待剩余的分片, 失败后不再派发新分片但仍需回收已派发的分片
+        while (running_task_num > 0) {
+            int task_index = done_queue.Pop();
+            --running_task_num;
             if (task_fail_flag) {
-                break;
+                continue;
             }
+            if (!CheckUploadTask(pptaskArr[task_index], task_part_numbers[task_index],
+                                 &part_etags, &part_crc64s, &result)) {
+                task_fail_flag = true;
+                continue;
+            }
+            // 失败前已上传成功的分块也要记录, 续传时可以跳过
+            SaveUploadCheckpoint(checkpoint, req.GetCheckpointFile(),
+                                 task_part_numbers[task_index], part_etags, part_crc64s);
         }
     }
 
     if (!task_fail_flag) {
+        std::map<uint64_t, std::string>::const_iterator itr = part_etags.begin();
+        for (; itr != part_etags.end(); ++itr) {
+            part_numbers_ptr->push_back(itr->first);
+            etags_ptr->push_back(itr->second);
+        }
+        *crc64_ptr = CombinePartCrc64(part_crc64s, part_etags.size(), part_size, file_size);
         result.SetSucc();
     }
 
     // 释放相关资源
     fin.close();
-    for (int i = 0; i< pool_size; ++i) {
+    for (int i = 0; i< buf_num; ++i) {
         delete pptaskArr[i];
     }
     delete [] pptaskArr;
 
-    for (int i = 0; i < pool_size; ++i) {
-        delete [] file_content_buf[i];
-    }
+    ReleasePartBuffers(part_size, buf_num, file_content_buf);
     delete [] file_content_buf;
 
     return result;
@@ -0,0 +1,982 @@
+#include "util/async_http_sender.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <deque>
+#include <list>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include "Poco/Net/Context.h"
+#include "Poco/URI.h"
+
+#include "cos_defines.h"
+#include "cos_sys_config.h"
+#include "util/dns_cache.h"
+#include "util/http_sender.h"
+#include "util/noncopyable.h"
+#include "util/simple_mutex.h"
+#include "util/socket_options.h"
+#include "util/ssl_context_cache.h"
+#include "util/string_util.h"
+#include "util/tls_session_cache.h"
+
+namespace qcloud_cos {
+
+namespace {
+
+// 每次从socket读取的最大字节数
+const size_t kRecvChunkSize = 16 * 1024;
+// 响应头的最大长度, 超过视为非法响应
+const size_t kMaxResponseHeaderSize = 64 * 1024;
+// epoll_wait的超时时间, 同时也是检查请求超时的周期
+const int kEpollWaitInms = 100;
+const int kMaxEpollEvents = 256;
+
+uint64_t GetNowInMs() {
+    return HttpSender::GetTimeStampInUs() / 1000;
+}
+
+std::string GetSslErrorString() {
+    unsigned long err = ERR_get_error();
+    if (err == 0) {
+        return std::string(strerror(errno));
+    }
+
+    char buf[256];
+    ERR_error_string_n(err, buf, sizeof(buf));
+    ERR_clear_error();
+    return std::string(buf);
+}
+
+// 忽略大小写查找header
+std::map<std::string, std::string>::const_iterator FindHeader(
+        const std::map<std::string, std::string>& headers, const std::string& name) {
+    for (std::map<std::string, std::string>::const_iterator itr = headers.begin();
+         itr != headers.end(); ++itr) {
+        if (StringUtil::StringToLower(itr->first) == StringUtil::StringToLower(name)) {
+            return itr;
+        }
+    }
+    return headers.end();
+}
+
+struct AsyncRequest {
+    AsyncRequest() : m_is_https(false), m_is_head(false), m_port(0), m_addr_len(0),
+        m_conn_timeout_in_ms(0), m_recv_timeout_in_ms(0), m_retried(false) {}
+
+    std::string GetEndpointKey() const {
+        return std::string(m_is_https ? "https://" : "http://") + m_host + ":"
+            + StringUtil::IntToString(m_port) + "@" + m_address;
+    }
+
+    bool m_is_https;
+    bool m_is_head;
+    std::string m_host;
+    uint16_t m_port;
+    // 实际连接的ip及对应的地址结构, 在调用线程中解析好, I/O线程不做阻塞的解析
+    std::string m_address;
+    struct sockaddr_storage m_addr;
+    socklen_t m_addr_len;
+    // 序列化后的请求行、请求头和body
+    std::string m_data;
+    uint64_t m_conn_timeout_in_ms;
+    uint64_t m_recv_timeout_in_ms;
+    AsyncHttpCallback m_callback;
+    // 复用的空闲连接可能已被服务端关闭, 此时允许在新连接上重试一次
+    bool m_retried;
+};
+
+/// 增量解析http响应, 支持Content-Length、chunked和以连接关闭结束的body
+class ResponseParser {
+public:
+    enum ParseRet {
+        PARSE_ERROR = -1,
+        PARSE_NEED_MORE = 0,
+        PARSE_DONE = 1
+    };
+
+    ResponseParser() { Reset(false); }
+
+    void Reset(bool is_head) {
+        m_is_head = is_head;
+        m_state = STATE_HEADER;
+        m_buf.clear();
+        m_pos = 0;
+        m_remaining = 0;
+        m_keep_alive = false;
+        m_result = AsyncHttpResult();
+    }
+
+    bool HasData() const { return m_state != STATE_HEADER || !m_buf.empty(); }
+
+    bool IsKeepAlive() const { return m_keep_alive; }
+
+    // 取出解析结果, 避免复制body
+    void SwapResult(AsyncHttpResult* result) {
+        std::swap(m_result.m_http_code, result->m_http_code);
+        m_result.m_resp_headers.swap(result->m_resp_headers);
+        m_result.m_resp_body.swap(result->m_resp_body);
+        m_result.m_err_msg.swap(result->m_err_msg);
+    }
+
+    int Parse(const char* data, size_t len) {
+        m_buf.append(data, len);
+        int ret = DoParse();
+        // 已解析的部分一次性移除, 避免每段数据都移动整个缓冲区
+        m_buf.erase(0, m_pos);
+        m_pos = 0;
+        return ret;
+    }
+
+    // 连接被对端关闭
+    int OnEof() {
+        if (m_state == STATE_UNTIL_CLOSE) {
+            m_state = STATE_DONE;
+            m_keep_alive = false;
+            return PARSE_DONE;
+        }
+        return m_state == STATE_DONE ? PARSE_DONE : PARSE_ERROR;
+    }
+
+private:
+    enum State {
+        STATE_HEADER,
+        STATE_LENGTH_BODY,
+        STATE_UNTIL_CLOSE,
+        STATE_CHUNK_SIZE,
+        STATE_CHUNK_DATA,
+        STATE_CHUNK_CRLF,
+        STATE_TRAILER,
+        STATE_DONE
+    };
+
+    size_t Available() const { return m_buf.size() - m_pos; }
+
+    static void StripCr(std::string* line) {
+        if (!line->empty() && (*line)[line->size() - 1] == '\r') {
+            line->erase(line->size() - 1);
+        }
+    }
+
+    // 读取一行(不含\r\n), 不完整时返回false
+    bool ReadLine(std::string* line) {
+        size_t end = m_buf.find("\r\n", m_pos);
+        if (end == std::string::npos) {
+            return false;
+        }
+        line->assign(m_buf, m_pos, end - m_pos);
+        m_pos = end + 2;
+        return true;
+    }
+
+    void ConsumeBody() {
+        size_t n = std::min((uint64_t)Available(), m_remaining);
+        m_result.m_resp_body.append(m_buf, m_pos, n);
+        m_pos += n;
+        m_remaining -= n;
+    }
+
+    bool ParseHeader(const std::string& header) {
+        m_result.m_resp_headers.clear();
+        std::istringstream iss(header);
+        std::string line;
+        if (!std::getline(iss, line)) {
+            return false;
+        }
+
+        // 状态行: HTTP/1.1 200 OK
+        StripCr(&line);
+        std::vector<std::string> fields;
+        StringUtil::SplitString(line, ' ', &fields);
+        if (fields.size() < 2 || !StringUtil::StringStartsWith(fields[0], "HTTP/")) {
+            return false;
+        }
+        bool is_http_10 = (fields[0] == "HTTP/1.0");
+        m_result.m_http_code = atoi(fields[1].c_str());
+        if (m_result.m_http_code < 100) {
+            return false;
+        }
+
+        while (std::getline(iss, line)) {
+            StripCr(&line);
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            std::string name = line.substr(0, colon);
+            std::string value = line.substr(colon + 1);
+            StringUtil::Trim(name);
+            StringUtil::Trim(value);
+            m_result.m_resp_headers.insert(std::make_pair(name, value));
+        }
+
+        std::string connection;
+        std::map<std::string, std::string>::const_iterator itr
+            = FindHeader(m_result.m_resp_headers, "Connection");
+        if (itr != m_result.m_resp_headers.end()) {
+            connection = StringUtil::StringToLower(itr->second);
+        }
+        m_keep_alive = is_http_10 ? (connection == "keep-alive") : (connection != "close");
+        return true;
+    }
+
+    int DoParse() {
+        while (true) {
+            switch (m_state) {
+            case STATE_HEADER: {
+                size_t end = m_buf.find("\r\n\r\n", m_pos);
+                if (end == std::string::npos) {
+                    return Available() > kMaxResponseHeaderSize ? PARSE_ERROR : PARSE_NEED_MORE;
+                }
+                if (!ParseHeader(m_buf.substr(m_pos, end - m_pos))) {
+                    return PARSE_ERROR;
+                }
+                m_pos = end + 4;
+
+                int http_code = m_result.m_http_code;
+                if (http_code < 200) {
+                    // 100-continue等中间响应, 继续解析真正的响应
+                    continue;
+                }
+
+                const std::map<std::string, std::string>& headers = m_result.m_resp_headers;
+                std::map<std::string, std::string>::const_iterator te_itr
+                    = FindHeader(headers, "Transfer-Encoding");
+                std::map<std::string, std::string>::const_iterator cl_itr
+                    = FindHeader(headers, "Content-Length");
+                if (m_is_head || http_code == 204 || http_code == 304) {
+                    m_state = STATE_DONE;
+                } else if (te_itr != headers.end()
+                           && StringUtil::StringToLower(te_itr->second) == "chunked") {
+                    m_state = STATE_CHUNK_SIZE;
+                } else if (cl_itr != headers.end()) {
+                    m_remaining = StringUtil::StringToUint64(cl_itr->second);
+                    m_state = STATE_LENGTH_BODY;
+                } else {
+                    m_state = STATE_UNTIL_CLOSE;
+                }
+                break;
+            }
+            case STATE_LENGTH_BODY:
+                ConsumeBody();
+                if (m_remaining > 0) {
+                    return PARSE_NEED_MORE;
+                }
+                m_state = STATE_DONE;
+                break;
+            case STATE_UNTIL_CLOSE:
+                m_result.m_resp_body.append(m_buf, m_pos, Available());
+                m_pos = m_buf.size();
+                return PARSE_NEED_MORE;
+            case STATE_CHUNK_SIZE: {
+                std::string line;
+                if (!ReadLine(&line)) {
+                    return PARSE_NEED_MORE;
+                }
+                // 忽略chunk扩展字段
+                size_t semicolon = line.find(';');
+                if (semicolon != std::string::npos) {
+                    line = line.substr(0, semicolon);
+                }
+                StringUtil::Trim(line);
+                char* end = NULL;
+                m_remaining = strtoull(line.c_str(), &end, 16);
+                if (line.empty() || *end != '\0') {
+                    return PARSE_ERROR;
+                }
+                m_state = (m_remaining == 0) ? STATE_TRAILER : STATE_CHUNK_DATA;
+                break;
+            }
+            case STATE_CHUNK_DATA:
+                ConsumeBody();
+                if (m_remaining > 0) {
+                    return PARSE_NEED_MORE;
+                }
+                m_state = STATE_CHUNK_CRLF;
+                break;
+            case STATE_CHUNK_CRLF:
+                if (Available() < 2) {
+                    return PARSE_NEED_MORE;
+                }
+                if (m_buf.compare(m_pos, 2, "\r\n") != 0) {
+                    return PARSE_ERROR;
+                }
+                m_pos += 2;
+                m_state = STATE_CHUNK_SIZE;
+                break;
+            case STATE_TRAILER: {
+                std::string line;
+                if (!ReadLine(&line)) {
+                    return PARSE_NEED_MORE;
+                }
+                if (line.empty()) {
+                    m_state = STATE_DONE;
+                }
+                break;
+            }
+            case STATE_DONE:
+                return PARSE_DONE;
+            }
+        }
+    }
+
+private:
+    bool m_is_head;
+    State m_state;
+    std::string m_buf;
+    size_t m_pos;
+    uint64_t m_remaining;
+    bool m_keep_alive;
+    AsyncHttpResult m_result;
+};
+
+enum ConnState {
+    CONN_CONNECTING,
+    CONN_HANDSHAKING,
+    CONN_SENDING,
+    CONN_RECEIVING,
+    CONN_IDLE
+};
+
+struct AsyncConnection : private NonCopyable {
+    AsyncConnection() : m_fd(-1), m_ssl(NULL), m_state(CONN_CONNECTING), m_request(NULL),
+        m_send_offset(0), m_deadline_in_ms(0), m_idle_since_in_ms(0), m_reused(false) {}
+
+    ~AsyncConnection() {
+        if (m_ssl != NULL) {
+            SSL_free(m_ssl);
+        }
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+
+    int m_fd;
+    SSL* m_ssl;
+    ConnState m_state;
+    std::string m_endpoint_key;
+    AsyncRequest* m_request;
+    size_t m_send_offset;
+    ResponseParser m_parser;
+    uint64_t m_deadline_in_ms;
+    uint64_t m_idle_since_in_ms;
+    bool m_reused;
+};
+
+typedef std::list<AsyncConnection*> ConnList;
+
+/// 单个I/O线程, 负责一部分请求的连接、发送和接收
+class EventLoop : private NonCopyable {
+public:
+    EventLoop() : m_epoll_fd(-1), m_event_fd(-1) {}
+
+    bool Start() {
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        m_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_epoll_fd < 0 || m_event_fd < 0) {
+            SDK_LOG_ERR("Create epoll fail, errno=%d", errno);
+            return false;
+        }
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_event_fd, &ev) != 0) {
+            SDK_LOG_ERR("Add eventfd to epoll fail, errno=%d", errno);
+            return false;
+        }
+
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, ThreadEntry, this) != 0) {
+            SDK_LOG_ERR("Create io thread fail, errno=%d", errno);
+            return false;
+        }
+        pthread_detach(tid);
+        return true;
+    }
+
+    void Submit(AsyncRequest* req) {
+        {
+            SimpleMutexLocker locker(&m_mutex);
+            m_pending.push_back(req);
+        }
+        uint64_t one = 1;
+        ssize_t ret = write(m_event_fd, &one, sizeof(one));
+        (void)ret;
+    }
+
+private:
+    static void* ThreadEntry(void* arg) {
+        static_cast<EventLoop*>(arg)->Run();
+        return NULL;
+    }
+
+    void Run() {
+        struct epoll_event events[kMaxEpollEvents];
+        while (true) {
+            int n = epoll_wait(m_epoll_fd, events, kMaxEpollEvents, kEpollWaitInms);
+            if (n < 0 && errno != EINTR) {
+                SDK_LOG_ERR("Epoll wait fail, errno=%d", errno);
+            }
+
+            for (int i = 0; i < n; ++i) {
+                AsyncConnection* conn = static_cast<AsyncConnection*>(events[i].data.ptr);
+                if (conn == NULL) {
+                    uint64_t count = 0;
+                    ssize_t ret = read(m_event_fd, &count, sizeof(count));
+                    (void)ret;
+                    continue;
+                }
+
+                if (conn->m_state == CONN_IDLE) {
+                    // 空闲连接上出现事件, 说明对端已关闭或连接异常
+                    RemoveIdle(conn);
+                    delete conn;
+                    continue;
+                }
+                Drive(conn);
+            }
+
+            DrainPending();
+            CheckTimeouts(GetNowInMs());
+        }
+    }
+
+    void DrainPending() {
+        std::deque<AsyncRequest*> pending;
+        {
+            SimpleMutexLocker locker(&m_mutex);
+            pending.swap(m_pending);
+        }
+
+        for (std::deque<AsyncRequest*>::iterator itr = pending.begin();
+             itr != pending.end(); ++itr) {
+            StartRequest(*itr);
+        }
+    }
+
+    void StartRequest(AsyncRequest* req) {
+        AsyncConnection* conn = AcquireIdle(req->GetEndpointKey());
+        if (conn != NULL) {
+            conn->m_reused = true;
+            SDK_LOG_DBG("Reuse idle connection, endpoint=%s", conn->m_endpoint_key.c_str());
+        } else {
+            std::string err_msg;
+            conn = Connect(req, &err_msg);
+            if (conn == NULL) {
+                Callback(req, err_msg);
+                return;
+            }
+        }
+
+        conn->m_request = req;
+        conn->m_send_offset = 0;
+        conn->m_parser.Reset(req->m_is_head);
+        m_active.insert(conn);
+        if (conn->m_state == CONN_IDLE) {
+            conn->m_state = CONN_SENDING;
+            conn->m_deadline_in_ms = GetNowInMs() + req->m_recv_timeout_in_ms;
+            Drive(conn);
+        }
+    }
+
+    AsyncConnection* Connect(AsyncRequest* req, std::string* err_msg) {
+        const struct sockaddr* addr = (const struct sockaddr*)&req->m_addr;
+        int fd = socket(addr->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            *err_msg = "Create socket fail, error=" + std::string(strerror(errno));
+            return NULL;
+        }
+
+        AsyncConnection* conn = new AsyncConnection();
+        conn->m_fd = fd;
+        conn->m_endpoint_key = req->GetEndpointKey();
+        conn->m_deadline_in_ms = GetNowInMs() + req->m_conn_timeout_in_ms;
+        // 在connect之前设置, 缓冲区大小可以在三次握手时生效
+        SocketOptions::Apply(fd);
+
+        if (connect(fd, addr, req->m_addr_len) != 0 && errno != EINPROGRESS) {
+            *err_msg = "Connect fail, address=" + req->m_address
+                + ", error=" + std::string(strerror(errno));
+            delete conn;
+            return NULL;
+        }
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLOUT;
+        ev.data.ptr = conn;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            *err_msg = "Add socket to epoll fail, error=" + std::string(strerror(errno));
+            delete conn;
+            return NULL;
+        }
+        conn->m_state = CONN_CONNECTING;
+        return conn;
+    }
+
+    void UpdateEvents(AsyncConnection* conn, uint32_t events) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.ptr = conn;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, conn->m_fd, &ev);
+    }
+
+    // 推进连接的状态, 直到需要等待I/O事件或请求结束
+    void Drive(AsyncConnection* conn) {
+        std::string err_msg;
+        while (true) {
+            switch (conn->m_state) {
+            case CONN_CONNECTING: {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                getsockopt(conn->m_fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                if (err != 0) {
+                    Fail(conn, "Connect fail, address=" + conn->m_request->m_address
+                         + ", error=" + std::string(strerror(err)));
+                    return;
+                }
+
+                if (conn->m_request->m_is_https) {
+                    if (!InitSsl(conn, &err_msg)) {
+                        Fail(conn, err_msg);
+                        return;
+                    }
+                    conn->m_state = CONN_HANDSHAKING;
+                } else {
+                    conn->m_state = CONN_SENDING;
+                    conn->m_deadline_in_ms = GetNowInMs() + conn->m_request->m_recv_timeout_in_ms;
+                }
+                break;
+            }
+            case CONN_HANDSHAKING: {
+                int ret = SSL_connect(conn->m_ssl);
+                if (ret == 1) {
+                    conn->m_state = CONN_SENDING;
+                    conn->m_deadline_in_ms = GetNowInMs() + conn->m_request->m_recv_timeout_in_ms;
+                    break;
+                }
+                if (!WaitSsl(conn, ret, &err_msg)) {
+                    Fail(conn, "SSL handshake fail, " + err_msg);
+                }
+                return;
+            }
+            case CONN_SENDING: {
+                const std::string& data = conn->m_request->m_data;
+                while (conn->m_send_offset < data.size()) {
+                    const char* buf = data.data() + conn->m_send_offset;
+                    size_t len = data.size() - conn->m_send_offset;
+                    int ret = 0;
+                    if (conn->m_ssl != NULL) {
+                        ret = SSL_write(conn->m_ssl, buf, (int)len);
+                        if (ret <= 0) {
+                            if (!WaitSsl(conn, ret, &err_msg)) {
+                                Fail(conn, "Send request fail, " + err_msg);
+                            }
+                            return;
+                        }
+                    } else {
+                        ret = (int)send(conn->m_fd, buf, len, MSG_NOSIGNAL);
+                        if (ret < 0) {
+                            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                                UpdateEvents(conn, EPOLLOUT);
+                            } else {
+                                Fail(conn, "Send request fail, error="
+                                     + std::string(strerror(errno)));
+                            }
+                            return;
+                        }
+                    }
+                    conn->m_send_offset += ret;
+                }
+                conn->m_state = CONN_RECEIVING;
+                conn->m_deadline_in_ms = GetNowInMs() + conn->m_request->m_recv_timeout_in_ms;
+                break;
+            }
+            case CONN_RECEIVING: {
+                char buf[kRecvChunkSize];
+                int ret = 0;
+                if (conn->m_ssl != NULL) {
+                    ret = SSL_read(conn->m_ssl, buf, sizeof(buf));
+                    if (ret <= 0 && SSL_get_error(conn->m_ssl, ret) != SSL_ERROR_ZERO_RETURN) {
+                        if (!WaitSsl(conn, ret, &err_msg)) {
+                            OnEof(conn, err_msg);
+                        }
+                        return;
+                    }
+                } else {
+                    ret = (int)recv(conn->m_fd, buf, sizeof(buf), 0);
+                    if (ret < 0) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                            UpdateEvents(conn, EPOLLIN);
+                        } else {
+                            OnEof(conn, std::string(strerror(errno)));
+                        }
+                        return;
+                    }
+                }
+
+                if (ret <= 0) {
+                    OnEof(conn, "connection closed by peer");
+                    return;
+                }
+
+                // 读到数据说明请求还在进行, 重新计算接收超时
+                conn->m_deadline_in_ms = GetNowInMs() + conn->m_request->m_recv_timeout_in_ms;
+                int parse_ret = conn->m_parser.Parse(buf, ret);
+                if (parse_ret == ResponseParser::PARSE_ERROR) {
+                    Fail(conn, "Parse response fail");
+                    return;
+                }
+                if (parse_ret == ResponseParser::PARSE_DONE) {
+                    Complete(conn);
+                    return;
+                }
+                break;
+            }
+            case CONN_IDLE:
+                return;
+            }
+        }
+    }
+
+    bool InitSsl(AsyncConnection* conn, std::string* err_msg) {
+        const AsyncRequest* req = conn->m_request;
+        Poco::Net::Context::Ptr context = SslContextCache::GetClientContext();
+        conn->m_ssl = SSL_new(context->sslContext());
+        if (conn->m_ssl == NULL || SSL_set_fd(conn->m_ssl, conn->m_fd) != 1) {
+            *err_msg = "Create ssl fail, " + GetSslErrorString();
+            return false;
+        }
+
+        SSL_set_tlsext_host_name(conn->m_ssl, req->m_host.c_str());
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L
+        // 连接的是ip, 证书需要按域名校验
+        if (CosSysConfig::GetSslVerifyMode() != COS_SSL_VERIFY_NONE) {
+            X509_VERIFY_PARAM_set1_host(SSL_get0_param(conn->m_ssl), req->m_host.c_str(), 0);
+        }
+#endif
+
+        // SSL_set_session会增加会话的引用计数, 不依赖缓存中的引用
+        SslSessionRef tls_session = TlsSessionCache::Instance().Get(req->m_host, req->m_port);
+        if (!tls_session.IsNull()) {
+            SSL_set_session(conn->m_ssl, tls_session.Get());
+        }
+        return true;
+    }
+
+    // ssl操作未完成时按需要的事件等待, 出错时返回false
+    bool WaitSsl(AsyncConnection* conn, int ret, std::string* err_msg) {
+        int err = SSL_get_error(conn->m_ssl, ret);
+        if (err == SSL_ERROR_WANT_READ) {
+            UpdateEvents(conn, EPOLLIN);
+            return true;
+        }
+        if (err == SSL_ERROR_WANT_WRITE) {
+            UpdateEvents(conn, EPOLLOUT);
+            return true;
+        }
+
+        *err_msg = "ssl_error=" + StringUtil::IntToString(err) + ", " + GetSslErrorString();
+        return false;
+    }
+
+    void OnEof(AsyncConnection* conn, const std::string& reason) {
+        if (conn->m_parser.OnEof() == ResponseParser::PARSE_DONE) {
+            Complete(conn);
+            return;
+        }
+        Fail(conn, "Receive response fail, " + reason);
+    }
+
+    void Complete(AsyncConnection* conn) {
+        AsyncRequest* req = conn->m_request;
+        m_active.erase(conn);
+        conn->m_request = NULL;
+
+        // tls1.3的会话票据在握手之后才下发, 因此在请求完成后保存会话
+        if (conn->m_ssl != NULL) {
+            // SSL_get1_session返回的引用由SslSessionRef接管
+            SslSessionRef ssl_session(SSL_get1_session(conn->m_ssl));
+            TlsSessionCache::Instance().Put(req->m_host, req->m_port, ssl_session);
+        }
+
+        AsyncHttpResult result;
+        conn->m_parser.SwapResult(&result);
+        if (conn->m_parser.IsKeepAlive()) {
+            ReleaseIdle(conn);
+        } else {
+            delete conn;
+        }
+
+        SDK_LOG_INFO("Send request over, status=%d", result.m_http_code);
+        InvokeCallback(req, result);
+    }
+
+    void Fail(AsyncConnection* conn, const std::string& err_msg) {
+        AsyncRequest* req = conn->m_request;
+        bool can_retry = conn->m_reused && !conn->m_parser.HasData() && !req->m_retried;
+        m_active.erase(conn);
+        delete conn;
+
+        if (can_retry) {
+            SDK_LOG_DBG("Idle connection broken, retry on new connection, err=%s",
+                        err_msg.c_str());
+            req->m_retried = true;
+            StartRequest(req);
+            return;
+        }
+        Callback(req, err_msg);
+    }
+
+    void Callback(AsyncRequest* req, const std::string& err_msg) {
+        SDK_LOG_ERR("Send request fail, host=%s, err=%s", req->m_host.c_str(), err_msg.c_str());
+        AsyncHttpResult result;
+        result.m_err_msg = err_msg;
+        InvokeCallback(req, result);
+    }
+
+    static void InvokeCallback(AsyncRequest* req, const AsyncHttpResult& result) {
+        try {
+            req->m_callback(result);
+        } catch (const std::exception& ex) {
+            SDK_LOG_ERR("Async http callback throw exception, %s", ex.what());
+        }
+        delete req;
+    }
+
+    AsyncConnection* AcquireIdle(const std::string& key) {
+        std::map<std::string, ConnList>::iterator itr = m_idle.find(key);
+        if (itr == m_idle.end() || itr->second.empty()) {
+            return NULL;
+        }
+
+        // 优先复用最近归还的连接, 空闲连接被关闭时会收到epoll事件并清理
+        AsyncConnection* conn = itr->second.back();
+        itr->second.pop_back();
+        return conn;
+    }
+
+    void ReleaseIdle(AsyncConnection* conn) {
+        ConnList& idle_list = m_idle[conn->m_endpoint_key];
+        // 上限为0时不限制空闲连接数
+        unsigned max_connections = CosSysConfig::GetMaxConnectionsPerHost();
+        if (!CosSysConfig::IsUseConnectionPool()
+            || (max_connections != 0 && idle_list.size() >= max_connections)) {
+            delete conn;
+            return;
+        }
+
+        conn->m_state = CONN_IDLE;
+        conn->m_idle_since_in_ms = GetNowInMs();
+        // 空闲连接不关注读写事件, 仍然会收到EPOLLHUP/EPOLLERR
+        UpdateEvents(conn, EPOLLRDHUP);
+        idle_list.push_back(conn);
+    }
+
+    void RemoveIdle(AsyncConnection* conn) {
+        std::map<std::string, ConnList>::iterator itr = m_idle.find(conn->m_endpoint_key);
+        if (itr != m_idle.end()) {
+            itr->second.remove(conn);
+        }
+    }
+
+    void CheckTimeouts(uint64_t now_in_ms) {
+        std::vector<AsyncConnection*> expired;
+        for (std::set<AsyncConnection*>::iterator itr = m_active.begin();
+             itr != m_active.end(); ++itr) {
+            if ((*itr)->m_deadline_in_ms <= now_in_ms) {
+                expired.push_back(*itr);
+            }
+        }
+
+        for (std::vector<AsyncConnection*>::iterator itr = expired.begin();
+             itr != expired.end(); ++itr) {
+            AsyncConnection* conn = *itr;
+            // 超时不重试, 避免超时时间翻倍
+            conn->m_reused = false;
+            Fail(conn, conn->m_state == CONN_RECEIVING || conn->m_state == CONN_SENDING
+                 ? "TimeoutException: receive response timeout"
+                 : "TimeoutException: connect timeout");
+        }
+
+        uint64_t idle_timeout_in_ms = CosSysConfig::GetConnectionIdleTimeoutInms();
+        for (std::map<std::string, ConnList>::iterator itr = m_idle.begin();
+             itr != m_idle.end(); ++itr) {
+            ConnList& idle_list = itr->second;
+            // 链表头部是最早归还的连接
+            while (!idle_list.empty()
+                   && now_in_ms - idle_list.front()->m_idle_since_in_ms >= idle_timeout_in_ms) {
+                delete idle_list.front();
+                idle_list.pop_front();
+            }
+        }
+    }
+
+private:
+    int m_epoll_fd;
+    int m_event_fd;
+    SimpleMutex m_mutex;
+    std::deque<AsyncRequest*> m_pending;
+    // 以下成员只在I/O线程中访问
+    std::set<AsyncConnection*> m_active;
+    std::map<std::string, ConnList> m_idle;
+};
+
+/// 持有全部I/O线程, 请求按轮询分配到各个线程
+class AsyncHttpEngine : private NonCopyable {
+public:
+    static AsyncHttpEngine& Instance() {
+        // I/O线程常驻, 不在进程退出时析构
+        static AsyncHttpEngine* s_engine = new AsyncHttpEngine();
+        return *s_engine;
+    }
+
+    bool Submit(AsyncRequest* req) {
+        if (m_loops.empty()) {
+            return false;
+        }
+
+        unsigned index = __sync_fetch_and_add(&m_next_loop, 1) % m_loops.size();
+        m_loops[index]->Submit(req);
+        return true;
+    }
+
+private:
+    AsyncHttpEngine() : m_next_loop(0) {
+        unsigned thread_num = CosSysConfig::GetAsyncHttpIoThreadNum();
+        if (thread_num == 0) {
+            thread_num = 1;
+        }
+
+        for (unsigned i = 0; i < thread_num; ++i) {
+            EventLoop* loop = new EventLoop();
+            if (loop->Start()) {
+                m_loops.push_back(loop);
+            } else {
+                delete loop;
+            }
+        }
+        SDK_LOG_INFO("Start async http engine, io_thread_num=%lu", m_loops.size());
+    }
+
+private:
+    std::vector<EventLoop*> m_loops;
+    unsigned m_next_loop;
+};
+
+// 填充请求: 解析url和目标地址, 序列化请求行、请求头和body
+bool InitRequest(AsyncRequest* req,
+                 const std::string& http_method,
+                 const std::string& url_str,
+                 const std::map<std::string, std::string>& req_params,
+                 const std::map<std::string, std::string>& req_headers,
+                 const std::string& req_body,
+                 std::string* err_msg) {
+    std::string path;
+    try {
+        Poco::URI url(url_str);
+        path = url.getPath();
+        req->m_is_https = StringUtil::StringStartsWithIgnoreCase(url_str, "https");
+        req->m_is_head = (StringUtil::StringToUpper(http_method) == "HEAD");
+        req->m_host = url.getHost();
+        req->m_port = url.getPort();
+        req->m_address = DnsCache::Instance().Resolve(req->m_host);
+    } catch (const Poco::Exception& ex) {
+        *err_msg = "Net Exception:" + ex.displayText();
+        return false;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+    struct addrinfo* addr_info = NULL;
+    std::string port_str = StringUtil::IntToString(req->m_port);
+    int ret = getaddrinfo(req->m_address.c_str(), port_str.c_str(), &hints, &addr_info);
+    if (ret != 0 || addr_info == NULL) {
+        *err_msg = "Resolve host fail, host=" + req->m_host + ", error=" + gai_strerror(ret);
+        return false;
+    }
+    memcpy(&req->m_addr, addr_info->ai_addr, addr_info->ai_addrlen);
+    req->m_addr_len = addr_info->ai_addrlen;
+    freeaddrinfo(addr_info);
+
+    std::string head = http_method + " "
+        + HttpSender::GetPathAndQuery(path, req_params) + " HTTP/1.1\r\n";
+    bool has_host = false;
+    for (std::map<std::string, std::string>::const_iterator c_itr = req_headers.begin();
+         c_itr != req_headers.end(); ++c_itr) {
+        std::string name = StringUtil::StringToLower(c_itr->first);
+        if (name == "content-length" || name == "connection") {
+            continue;
+        }
+        has_host = has_host || (name == "host");
+        head += c_itr->first + ": " + c_itr->second + "\r\n";
+    }
+
+    if (!has_host) {
+        head += "Host: " + req->m_host + "\r\n";
+    }
+    head += "Content-Length: " + StringUtil::Uint64ToString(req_body.size()) + "\r\n";
+    head += CosSysConfig::IsUseConnectionPool() ? "Connection: Keep-Alive\r\n"
+                                                : "Connection: close\r\n";
+    head += "\r\n";
+    SDK_LOG_DBG("request=[%s]", head.c_str());
+
+    req->m_data.reserve(head.size() + req_body.size());
+    req->m_data = head;
+    req->m_data += req_body;
+    return true;
+}
+
+} // namespace
+
+void AsyncHttpSender::SendRequest(const std::string& http_method,
+                                  const std::string& url_str,
+                                  const std::map<std::string, std::string>& req_params,
+                                  const std::map<std::string, std::string>& req_headers,
+                                  const std::string& req_body,
+                                  uint64_t conn_timeout_in_ms,
+                                  uint64_t recv_timeout_in_ms,
+                                  const AsyncHttpCallback& callback) {
+    AsyncRequest* req = new AsyncRequest();
+    req->m_conn_timeout_in_ms = conn_timeout_in_ms;
+    req->m_recv_timeout_in_ms = recv_timeout_in_ms;
+    req->m_callback = callback;
+
+    AsyncHttpResult result;
+    if (!InitRequest(req, http_method, url_str, req_params, req_headers, req_body,
+                     &result.m_err_msg)) {
+        SDK_LOG_ERR("Init async request fail, %s", result.m_err_msg.c_str());
+        delete req;
+        callback(result);
+        return;
+    }
+
+    if (!AsyncHttpEngine::Instance().Submit(req)) {
+        delete req;
+        result.m_err_msg = "Async http engine is not available";
+        SDK_LOG_ERR("%s", result.m_err_msg.c_str());
+        callback(result);
+    }
+}
+
+} // namespace qcloud_cos
@@ -2,92 +2,217 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <string.h>
 #include <strings.h>
 
 #include <iostream>
 #include <algorithm>
 
+#include <boost/thread/tss.hpp>
+
 #include "util/codec_util.h"
 #include "util/sha1.h"
+#include "util/simple_mutex.h"
 #include "util/string_util.h"
 #include "util/http_sender.h"
+#include "cos_defines.h"
 #include "cos_sys_config.h"
 
 namespace qcloud_cos {
 
-void AuthTool::FilterAndSetSignHeader(const std::map<std::string,std::string> &headers,
-                                      std::map<std::string, std::string>* filted_req_headers) {
-    for(std::map<std::string, std::string>::const_iterator itr = headers.begin();
-        itr != headers.end(); ++itr) {
-        if( (itr->first[0] == 'x' || itr->first[0] == 'X')
-            || !strcasecmp(itr->first.c_str(), "content-type")
-            || !strcasecmp(itr->first.c_str(), "host")) {
-            filted_req_headers->insert(std::make_pair(itr->first, itr->second));
-        }
+namespace {
+
+// hmac-sha1的16进制长度
+const size_t kSignHexLen = 40;
+
+// SHA-1(secret_key)的16进制 -> (key_time, sign_key), 每个secret_key只保留最近使用的窗口.
+// 缓存在进程内长期存在, 以摘要为key避免在内存中多保留一份明文secret_key
+typedef std::map<std::string, std::pair<std::string, std::string> > SignKeyMap;
+
+SimpleMutex& GetSignKeyMutex() {
+    static SimpleMutex* s_mutex = new SimpleMutex();
+    return *s_mutex;
+}
+
+SignKeyMap& GetSignKeyMap() {
+    static SignKeyMap* s_sign_keys = new SignKeyMap();
+    return *s_sign_keys;
+}
+
+// 参与签名的一个header或param, key已转小写, value已url编码
+struct SignEntry {
+    std::string key;
+    std::string value;
+};
+
+bool SignEntryLess(const SignEntry* a, const SignEntry* b) {
+    return a->key < b->key;
+}
+
+// 签名过程中使用的临时buffer和摘要对象, 每个线程一份, 字符串清空后保留容量, 稳定后签名不再分配内存
+struct SignScratch {
+    SignScratch() : entry_num(0) {}
+
+    std::vector<SignEntry> entries;
+    size_t entry_num;
+    std::vector<const SignEntry*> sorted;
+    std::string param_list;
+    std::string header_list;
+    std::string format_str;
+    std::string string_to_sign;
+    Sha1 sha1;
+    // secret_key的SHA-1, 作为SignKey缓存的key
+    std::string secret_digest;
+    // 分别以secret_key和sign_key为key, 预先计算好的hmac状态在同一窗口内反复使用
+    HmacSha1Context secret_hmac;
+    HmacSha1Context sign_key_hmac;
+};
+
+SignScratch& GetSignScratch() {
+    static boost::thread_specific_ptr<SignScratch>* s_scratch =
+        new boost::thread_specific_ptr<SignScratch>();
+    SignScratch* scratch = s_scratch->get();
+    if (scratch == NULL) {
+        scratch = new SignScratch();
+        s_scratch->reset(scratch);
     }
+    return *scratch;
 }
 
-void AuthTool::FillMap(const std::map<std::string,std::string> &params,
-                       bool key_encode,
-                       bool value_encode,
-                       bool value_lower,
-                       std::string* param_list,
-                       std::string* param_value_list) {
-    if (params.empty()) {
-        return;
+SignEntry* AddSignEntry(SignScratch* scratch, const std::string& key, const std::string& value) {
+    if (scratch->entry_num == scratch->entries.size()) {
+        scratch->entries.push_back(SignEntry());
+    }
+    SignEntry* entry = &scratch->entries[scratch->entry_num++];
+    entry->key.assign(key);
+    for (size_t i = 0; i < entry->key.size(); ++i) {
+        entry->key[i] = ::tolower((unsigned char)entry->key[i]);
     }
+    entry->value.clear();
+    CodecUtil::UrlEncode(value, &entry->value);
+    return entry;
+}
 
-    std::map<std::string, std::string>::const_iterator itr;
-    std::map<std::string, std::string> trim_params;
+// 只有host、content-type以及x开头的header参与签名
+bool IsSignHeader(const std::string& key) {
+    return (!key.empty() && (key[0] == 'x' || key[0] == 'X'))
+        || !strcasecmp(key.c_str(), "content-type")
+        || !strcasecmp(key.c_str(), "host");
+}
 
-    for (itr = params.begin(); itr != params.end(); ++itr) {
-        std::string key = itr->first;
-        std::string value;
+// 把scratch中[begin, entry_num)的条目按小写key排序, 小写后重复的key保留最后一个,
+// key以;分隔追加到list, key=value以&分隔追加到value_list
+void AppendSortedEntries(SignScratch* scratch, size_t begin, bool key_encode,
+                         std::string* list, std::string* value_list) {
+    scratch->sorted.clear();
+    for (size_t i = begin; i < scratch->entry_num; ++i) {
+        scratch->sorted.push_back(&scratch->entries[i]);
+    }
+    std::stable_sort(scratch->sorted.begin(), scratch->sorted.end(), SignEntryLess);
 
-        if(value_encode) {
-            value = CodecUtil::UrlEncode(itr->second);
-        } else {
-            value = itr->second;
+    bool is_first = true;
+    for (size_t i = 0; i < scratch->sorted.size(); ++i) {
+        if (i + 1 < scratch->sorted.size()
+            && scratch->sorted[i]->key == scratch->sorted[i + 1]->key) {
+            continue;
         }
 
-        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-        if(value_lower) {
-            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        const SignEntry* entry = scratch->sorted[i];
+        if (!is_first) {
+            *list += ';';
+            *value_list += '&';
         }
-        trim_params[key] = value;
+        is_first = false;
+
+        size_t key_begin = list->size();
+        if (key_encode) {
+            CodecUtil::UrlEncode(entry->key, list);
+        } else {
+            list->append(entry->key);
+        }
+        value_list->append(*list, key_begin, std::string::npos);
+        *value_list += '=';
+        value_list->append(entry->value);
     }
+}
 
-    itr = trim_params.begin();
+void FormatTimeRange(uint64_t start_time_in_s, uint64_t end_time_in_s, char* buf, size_t len) {
+    snprintf(buf, len, "%lu;%lu", start_time_in_s, end_time_in_s);
+}
 
-    if (key_encode) {
-        param_list->append(CodecUtil::UrlEncode(itr->first));
-        *param_value_list += CodecUtil::UrlEncode(itr->first) + "=" + itr->second;
-    } else {
-        param_list->append(itr->first);
-        *param_value_list += itr->first + "=" + itr->second;
-    }
+} // namespace
 
-    for (++itr; itr != trim_params.end(); ++itr) {
-        if(key_encode) {
-            *param_list += ";" + CodecUtil::UrlEncode(itr->first);
-            *param_value_list += "&" + CodecUtil::UrlEncode(itr->first) + "=" + itr->second;
-        } else {
-            *param_list += ";" + itr->first;
-            *param_value_list += "&" + itr->first + "=" + itr->second;
+void AuthTool::GetSignKey(const std::string& secret_key, const char* key_time, char* sign_key) {
+    SignScratch& scratch = GetSignScratch();
+    char secret_sha1[SHA_DIGESTSIZE * 2 + 1];
+    scratch.sha1.Reset();
+    scratch.sha1.Append(secret_key.data(), secret_key.size());
+    scratch.sha1.Final(secret_sha1);
+    scratch.secret_digest.assign(secret_sha1, SHA_DIGESTSIZE * 2);
+    const std::string& secret_digest = scratch.secret_digest;
+
+    {
+        SimpleMutexLocker locker(&GetSignKeyMutex());
+        SignKeyMap::const_iterator itr = GetSignKeyMap().find(secret_digest);
+        if (itr != GetSignKeyMap().end() && itr->second.first == key_time) {
+            memcpy(sign_key, itr->second.second.data(), kSignHexLen);
+            return;
         }
     }
+
+    unsigned char digest[kSignHexLen / 2];
+    HmacSha1Context& secret_hmac = scratch.secret_hmac;
+    secret_hmac.SetKey(secret_key.data(), secret_key.size());
+    secret_hmac.Calc(key_time, strlen(key_time), digest);
+    CodecUtil::BinToHex(digest, sizeof(digest), sign_key);
+    for (size_t i = 0; i < kSignHexLen; ++i) {
+        sign_key[i] = ::tolower((unsigned char)sign_key[i]);
+    }
+
+    SimpleMutexLocker locker(&GetSignKeyMutex());
+    SignKeyMap& sign_keys = GetSignKeyMap();
+    if (sign_keys.size() >= kMaxSignKeyCacheSize
+        && sign_keys.find(secret_digest) == sign_keys.end()) {
+        sign_keys.clear();
+    }
+    sign_keys[secret_digest] = std::make_pair(std::string(key_time),
+                                           std::string(sign_key, kSignHexLen));
 }
 
 std::string AuthTool::Sign(const std::string& access_key, const std::string& secret_key,
                            const std::string& http_method, const std::string& in_uri,
                            const std::map<std::string, std::string>& headers,
                            const std::map<std::string, std::string>& params) {
-    uint64_t expired_time_in_s = CosSysConfig::GetAuthExpiredTime();
-    uint64_t start_time_in_s = HttpSender::GetTimeStampInUs() / 1000000;
+    return SignInKeyWindow(access_key, secret_key, http_method, in_uri, headers, params,
+                           HttpSender::GetTimeStampInUs() / 1000000,
+                           CosSysConfig::GetAuthExpiredTime());
+}
+
+std::string AuthTool::SignInKeyWindow(const std::string& access_key,
+                                      const std::string& secret_key,
+                                      const std::string& http_method,
+                                      const std::string& in_uri,
+                                      const std::map<std::string, std::string>& headers,
+                                      const std::map<std::string, std::string>& params,
+                                      uint64_t start_time_in_s,
+                                      uint64_t expired_time_in_s) {
     uint64_t end_time_in_s = start_time_in_s + expired_time_in_s;
+    char sign_time[48];
+    FormatTimeRange(start_time_in_s, end_time_in_s, sign_time, sizeof(sign_time));
+    if (expired_time_in_s == 0) {
+        return Sign(access_key, secret_key, http_method, in_uri, headers, params,
+                    sign_time, sign_time);
+    }
 
-    return Sign(access_key, secret_key, http_method, in_uri, headers, params, start_time_in_s,
-                end_time_in_s);
+    // q-key-time按有效期对齐到[key_start, key_start + 2 * expired), 总是覆盖q-sign-time,
+    // 同一窗口内的请求只需计算string_to_sign的HMAC. 签名的有效期仍由q-sign-time决定
+    uint64_t key_start_in_s = start_time_in_s - start_time_in_s % expired_time_in_s;
+    uint64_t key_end_in_s = key_start_in_s + 2 * expired_time_in_s;
+    char key_time[48];
+    FormatTimeRange(key_start_in_s, key_end_in_s, key_time, sizeof(key_time));
+
+    return Sign(access_key, secret_key, http_method, in_uri, headers, params,
+                sign_time, key_time);
 }
 
 std::string AuthTool::Sign(const std::string& access_key, const std::string& secret_key,
@@ -96,52 +221,112 @@ std::string AuthTool::Sign(const std::string& access_key, const std::string& sec
                            const std::map<std::string, std::string>& params,
                            uint64_t start_time_in_s,
                            uint64_t end_time_in_s) {
+    char start_end_time[48];
+    FormatTimeRange(start_time_in_s, end_time_in_s, start_end_time, sizeof(start_end_time));
+    return Sign(access_key, secret_key, http_method, in_uri, headers, params,
+                start_end_time, start_end_time);
+}
+
+std::string AuthTool::Sign(const std::string& access_key, const std::string& secret_key,
+                           const std::string& http_method, const std::string& in_uri,
+                           const std::map<std::string, std::string>& headers,
+                           const std::map<std::string, std::string>& params,
+                           const char* sign_time, const char* key_time) {
     if (access_key.empty() || secret_key.empty()) {
         return "";
     }
-    std::string start_end_time_str = StringUtil::Uint64ToString(start_time_in_s) + ";"
-        + StringUtil::Uint64ToString(end_time_in_s);
 
-    // 1. 获取签名所需的path/params/headers
-    std::map<std::string, std::string> filted_req_headers;
-    FilterAndSetSignHeader(headers, &filted_req_headers);
+    SignScratch& scratch = GetSignScratch();
+    scratch.entry_num = 0;
+    scratch.param_list.clear();
+    scratch.header_list.clear();
+    scratch.format_str.clear();
 
-    // 2. 将header和params拼接为字符串
-    std::string header_list, header_value_list;
-    std::string param_list, param_value_list;
+    // 1. format string: method\nuri\nparam_value_list\nheader_value_list\n
+    size_t method_begin = scratch.format_str.size();
+    scratch.format_str.append(http_method);
+    for (size_t i = method_begin; i < scratch.format_str.size(); ++i) {
+        scratch.format_str[i] = ::tolower((unsigned char)scratch.format_str[i]);
+    }
+    scratch.format_str += '\n';
+    if (in_uri.empty()) {
+        scratch.format_str += '/';
+    } else {
+        scratch.format_str.append(in_uri);
+    }
+    scratch.format_str += '\n';
 
-    FillMap(params, true, true, false, &param_list, &param_value_list);
-    FillMap(filted_req_headers, false, true, false, &header_list, &header_value_list);
+    // 2. params的key和value都需要编码, header只编码value
+    for (std::map<std::string, std::string>::const_iterator itr = params.begin();
+         itr != params.end(); ++itr) {
+        AddSignEntry(&scratch, itr->first, itr->second);
+    }
+    AppendSortedEntries(&scratch, 0, true, &scratch.param_list, &scratch.format_str);
+    scratch.format_str += '\n';
 
-    std::string uri = in_uri;
-    if (uri.empty()) {
-        uri = "/";
+    size_t header_begin = scratch.entry_num;
+    for (std::map<std::string, std::string>::const_iterator itr = headers.begin();
+         itr != headers.end(); ++itr) {
+        if (IsSignHeader(itr->first)) {
+            AddSignEntry(&scratch, itr->first, itr->second);
+        }
     }
+    AppendSortedEntries(&scratch, header_begin, false, &scratch.header_list, &scratch.format_str);
+    scratch.format_str += '\n';
 
-    // 3. format string
-    std::string lower_method = StringUtil::StringToLower(http_method);
-    std::string format_str= lower_method + "\n" + uri + "\n"
-        + param_value_list + "\n" + header_value_list + "\n";
+    // 3. StringToSign
+    char format_sha1[SHA_DIGESTSIZE * 2 + 1];
+    scratch.sha1.Reset();
+    scratch.sha1.Append(scratch.format_str.data(), scratch.format_str.size());
+    scratch.sha1.Final(format_sha1);
 
-    // 4. StringToSign
-    Sha1 sha1;
-    sha1.Append(format_str.c_str(), format_str.size());
-    std::string string_to_sign= "sha1\n" + start_end_time_str + "\n" + sha1.Final() + "\n";
-
-    // 5. signature
-    std::string sign_key = CodecUtil::HmacSha1Hex(start_end_time_str, secret_key);
-    std::transform(sign_key.begin(), sign_key.end(), sign_key.begin(), ::tolower);
-
-    std::string signature = CodecUtil::HmacSha1Hex(string_to_sign, sign_key);
-    std::transform(signature.begin(), signature.end(), signature.begin(), ::tolower);
-
-    // 6. 拼接
-    std::string req_sign = "q-sign-algorithm=sha1&q-ak=" + access_key +
-                           "&q-sign-time=" + start_end_time_str +
-                           "&q-key-time=" + start_end_time_str +
-                           "&q-header-list=" + header_list +
-                           "&q-url-param-list=" + param_list +
-                           "&q-signature=" + signature;
+    scratch.string_to_sign.assign("sha1\n");
+    scratch.string_to_sign.append(sign_time);
+    scratch.string_to_sign += '\n';
+    scratch.string_to_sign.append(format_sha1);
+    scratch.string_to_sign += '\n';
+
+    // 4. signature
+    char sign_key[kSignHexLen];
+    GetSignKey(secret_key, key_time, sign_key);
+
+    unsigned char digest[kSignHexLen / 2];
+    scratch.sign_key_hmac.SetKey(sign_key, kSignHexLen);
+    scratch.sign_key_hmac.Calc(scratch.string_to_sign.data(), scratch.string_to_sign.size(),
+                               digest);
+    char signature[kSignHexLen];
+    CodecUtil::BinToHex(digest, sizeof(digest), signature);
+    for (size_t i = 0; i < kSignHexLen; ++i) {
+        signature[i] = ::tolower((unsigned char)signature[i]);
+    }
+
+    // 5. 拼接, 只为返回值分配一次内存
+    static const char kAlgorithm[] = "q-sign-algorithm=sha1&q-ak=";
+    static const char kSignTime[] = "&q-sign-time=";
+    static const char kKeyTime[] = "&q-key-time=";
+    static const char kHeaderList[] = "&q-header-list=";
+    static const char kParamList[] = "&q-url-param-list=";
+    static const char kSignature[] = "&q-signature=";
+    size_t sign_time_len = strlen(sign_time);
+    size_t key_time_len = strlen(key_time);
+
+    std::string req_sign;
+    req_sign.reserve(sizeof(kAlgorithm) + access_key.size() + sizeof(kSignTime) + sign_time_len
+                     + sizeof(kKeyTime) + key_time_len + sizeof(kHeaderList)
+                     + scratch.header_list.size() + sizeof(kParamList)
+                     + scratch.param_list.size() + sizeof(kSignature) + kSignHexLen);
+    req_sign.append(kAlgorithm, sizeof(kAlgorithm) - 1);
+    req_sign.append(access_key);
+    req_sign.append(kSignTime, sizeof(kSignTime) - 1);
+    req_sign.append(sign_time, sign_time_len);
+    req_sign.append(kKeyTime, sizeof(kKeyTime) - 1);
+    req_sign.append(key_time, key_time_len);
+    req_sign.append(kHeaderList, sizeof(kHeaderList) - 1);
+    req_sign.append(scratch.header_list);
+    req_sign.append(kParamList, sizeof(kParamList) - 1);
+    req_sign.append(scratch.param_list);
+    req_sign.append(kSignature, sizeof(kSignature) - 1);
+    req_sign.append(signature, kSignHexLen);
 
     return req_sign;
 }
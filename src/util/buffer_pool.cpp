@@ -0,0 +1,128 @@
+#include "util/buffer_pool.h"
+
+#include <sys/mman.h>
+
+#include "cos_defines.h"
+#include "cos_sys_config.h"
+
+namespace qcloud_cos {
+
+BufferPool& BufferPool::Instance() {
+    // 与HttpSessionPool相同, 不在进程退出时析构, 空闲buffer由CosAPI在最后一个实例析构时Clear
+    static BufferPool* s_pool = new BufferPool();
+    return *s_pool;
+}
+
+uint64_t BufferPool::GetClassSize(uint64_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    return (size + kBufferPoolClassUnit - 1) / kBufferPoolClassUnit * kBufferPoolClassUnit;
+}
+
+unsigned char* BufferPool::Acquire(uint64_t size) {
+    return Acquire(size, true);
+}
+
+unsigned char* BufferPool::TryAcquire(uint64_t size) {
+    return Acquire(size, false);
+}
+
+unsigned char* BufferPool::Acquire(uint64_t size, bool is_block) {
+    uint64_t class_size = GetClassSize(size);
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (true) {
+        std::vector<unsigned char*>& idle_list = m_idle_buffers[class_size];
+        if (!idle_list.empty()) {
+            unsigned char* buf = idle_list.back();
+            idle_list.pop_back();
+            m_in_use_size += class_size;
+            return buf;
+        }
+
+        // 先释放其他大小的空闲buffer腾出额度
+        uint64_t max_size = CosSysConfig::GetBufferPoolMaxSize();
+        while (m_total_size + class_size > max_size && EvictOneIdle()) {
+        }
+
+        if (m_total_size + class_size <= max_size || m_in_use_size == 0) {
+            unsigned char* buf = Allocate(class_size);
+            if (buf == NULL) {
+                SDK_LOG_ERR("Allocate buffer fail, size=%lu", class_size);
+                return NULL;
+            }
+            m_total_size += class_size;
+            m_in_use_size += class_size;
+            return buf;
+        }
+
+        if (!is_block) {
+            return NULL;
+        }
+        SDK_LOG_DBG("Buffer pool is full, total_size=%lu, wait for release", m_total_size);
+        m_cond.wait(lock);
+    }
+}
+
+void BufferPool::Release(unsigned char* buf, uint64_t size) {
+    if (buf == NULL) {
+        return;
+    }
+
+    uint64_t class_size = GetClassSize(size);
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_idle_buffers[class_size].push_back(buf);
+        m_in_use_size -= class_size;
+        // 上限被调小时归还的buffer不再缓存
+        while (m_total_size > CosSysConfig::GetBufferPoolMaxSize() && EvictOneIdle()) {
+        }
+    }
+    m_cond.notify_all();
+}
+
+void BufferPool::Clear() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (EvictOneIdle()) {
+    }
+    m_idle_buffers.clear();
+}
+
+uint64_t BufferPool::GetTotalSize() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_total_size;
+}
+
+bool BufferPool::EvictOneIdle() {
+    std::map<uint64_t, std::vector<unsigned char*> >::iterator itr = m_idle_buffers.begin();
+    for (; itr != m_idle_buffers.end(); ++itr) {
+        if (!itr->second.empty()) {
+            Free(itr->second.back(), itr->first);
+            itr->second.pop_back();
+            m_total_size -= itr->first;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 直接mmap匿名内存, 释放时立即归还系统; 开启大页时建议内核使用透明大页, 减少TLB miss
+unsigned char* BufferPool::Allocate(uint64_t class_size) {
+    void* buf = mmap(NULL, class_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) {
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    if (CosSysConfig::IsBufferPoolUseHugePage()) {
+        madvise(buf, class_size, MADV_HUGEPAGE);
+    }
+#endif
+    return static_cast<unsigned char*>(buf);
+}
+
+void BufferPool::Free(unsigned char* buf, uint64_t class_size) {
+    munmap(buf, class_size);
+}
+
+} // namespace qcloud_cos
@@ -13,8 +13,11 @@
 #include <openssl/hmac.h>
 #include <openssl/md5.h>
 
+#include <boost/thread/tss.hpp>
+
 #include "util/file_util.h"
 #include "util/sha1.h"
+#include "util/url_encode.h"
 #include <openssl/sha.h>
 
 namespace qcloud_cos {
@@ -22,6 +25,22 @@ namespace qcloud_cos {
 #define REVERSE_HEX(c) ( ((c) >= 'A') ? ((c) & 0xDF) - 'A' + 10 : (c) - '0' )
 #define HMAC_LENGTH 20
 
+namespace {
+
+// CodecUtil::HmacSha1*使用的线程私有context, 连续使用同一个key时不需要重新设置key
+HmacSha1Context& GetThreadHmacSha1Context() {
+    static boost::thread_specific_ptr<HmacSha1Context>* s_context =
+        new boost::thread_specific_ptr<HmacSha1Context>();
+    HmacSha1Context* context = s_context->get();
+    if (context == NULL) {
+        context = new HmacSha1Context();
+        s_context->reset(context);
+    }
+    return *context;
+}
+
+} // namespace
+
 unsigned char CodecUtil::ToHex(const unsigned char &x) {
     return x > 9 ? (x - 10 + 'A') : x + '0';
 }
@@ -35,44 +54,20 @@ void CodecUtil::BinToHex(const unsigned char *bin,unsigned int binLen, char *hex
 
 std::string CodecUtil::EncodeKey(const std::string& key) {
     std::string encodedKey = "";
-    std::size_t length = key.length();
-    for (size_t i = 0; i < length; ++i) {
-        if (isalnum((unsigned char)key[i]) ||
-            (key[i] == '-') ||
-            (key[i] == '_') ||
-            (key[i] == '.') ||
-            (key[i] == '~') ||
-            (key[i] == '/')) {
-            encodedKey += key[i];
-        } else {
-            encodedKey += '%';
-            encodedKey += ToHex((unsigned char)key[i] >> 4);
-            encodedKey += ToHex((unsigned char)key[i] % 16);
-        }
-    }
+    UrlEncodeAppend(key, true, &encodedKey);
     return encodedKey;
 }
 
 std::string CodecUtil::UrlEncode(const std::string& str) {
     std::string encodedUrl = "";
-    std::size_t length = str.length();
-    for (size_t i = 0; i < length; ++i) {
-        if (isalnum((unsigned char)str[i]) ||
-            (str[i] == '-') ||
-            (str[i] == '_') ||
-            (str[i] == '.') ||
-            (str[i] == '~')) {
-
-            encodedUrl += str[i];
-        } else {
-            encodedUrl += '%';
-            encodedUrl += ToHex((unsigned char)str[i] >> 4);
-            encodedUrl += ToHex((unsigned char)str[i] % 16);
-        }
-    }
+    UrlEncodeAppend(str, false, &encodedUrl);
     return encodedUrl;
 }
 
+void CodecUtil::UrlEncode(const std::string& str, std::string* out) {
+    UrlEncodeAppend(str, false, out);
+}
+
 std::string CodecUtil::Base64Encode(const std::string& plain_text) {
     static const char b64_table[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
@@ -102,19 +97,39 @@ std::string CodecUtil::Base64Encode(const std::string& plain_text) {
     return retval;
 }
 
+HmacSha1Context::HmacSha1Context() : m_ctx(new HMAC_CTX), m_has_key(false) {
+    HMAC_CTX_init(m_ctx);
+}
+
+HmacSha1Context::~HmacSha1Context() {
+    HMAC_CTX_cleanup(m_ctx);
+    delete m_ctx;
+}
+
+void HmacSha1Context::SetKey(const char* key, size_t key_len) {
+    if (m_has_key && m_key.size() == key_len && memcmp(m_key.data(), key, key_len) == 0) {
+        return;
+    }
+    HMAC_Init_ex(m_ctx, key, key_len, EVP_sha1(), NULL);
+    m_key.assign(key, key_len);
+    m_has_key = true;
+}
+
+void HmacSha1Context::Calc(const char* plain_text, size_t plain_text_len,
+                           unsigned char* digest) {
+    // key为NULL时只把SetKey时计算好的ipad状态复制回来, 不重新处理key
+    HMAC_Init_ex(m_ctx, NULL, 0, NULL, NULL);
+    HMAC_Update(m_ctx, (const unsigned char*)plain_text, plain_text_len);
+    unsigned int digest_len = 0;
+    HMAC_Final(m_ctx, digest, &digest_len);
+}
+
 std::string CodecUtil::HmacSha1(const std::string& plain_text, const std::string& key) {
-    const EVP_MD *engine = EVP_sha1();
-    unsigned char *output = (unsigned char *)malloc(EVP_MAX_MD_SIZE);
-    unsigned int output_len = 0;
-    HMAC_CTX ctx;
-    HMAC_CTX_init(&ctx);
-    HMAC_Init_ex(&ctx, (char *)key.c_str(), key.length(), engine, NULL);
-    HMAC_Update(&ctx, (unsigned char*)plain_text.c_str(), plain_text.length());
-    HMAC_Final(&ctx, output, &output_len);
-    HMAC_CTX_cleanup(&ctx);
-    std::string hmac_sha1_ret((char *)output, output_len);
-    free(output);
-    return hmac_sha1_ret;
+    unsigned char output[HMAC_LENGTH];
+    HmacSha1Context& context = GetThreadHmacSha1Context();
+    context.SetKey(key.data(), key.size());
+    context.Calc(plain_text.data(), plain_text.size(), output);
+    return std::string((char *)output, HMAC_LENGTH);
 }
 
 std::string CodecUtil::HmacSha1Hex(const std::string& plain_text,const std::string& key) {
@@ -125,6 +140,15 @@ std::string CodecUtil::HmacSha1Hex(const std::string& plain_text,const std::stri
     return std::string(hex, (HMAC_LENGTH << 1));
 }
 
+void CodecUtil::HmacSha1Hex(const char* plain_text, size_t plain_text_len,
+                            const char* key, size_t key_len, char* hex) {
+    unsigned char output[HMAC_LENGTH];
+    HmacSha1Context& context = GetThreadHmacSha1Context();
+    context.SetKey(key, key_len);
+    context.Calc(plain_text, plain_text_len, output);
+    BinToHex(output, HMAC_LENGTH, hex);
+}
+
 std::string CodecUtil::RawMd5(const std::string& plainText) {
     const int md5_length = 16;
     unsigned char md[md5_length];
@@ -0,0 +1,209 @@
+#include "util/crc64.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#define COS_CRC64_USE_PCLMUL 1
+#endif
+
+namespace qcloud_cos {
+
+namespace {
+
+// ECMA-182多项式0x42F0E1EBA9EA3693按位反转后的值
+const uint64_t kCrc64Poly = 0xC96C5795D7870F42ULL;
+
+// 数据不少于该长度时才使用PCLMULQDQ, 短数据查表更快
+const size_t kPclmulMinLen = 256;
+
+class Crc64Table {
+public:
+    Crc64Table() {
+        for (int i = 0; i < 256; ++i) {
+            uint64_t crc = i;
+            for (int j = 0; j < 8; ++j) {
+                crc = (crc & 1) ? (crc >> 1) ^ kCrc64Poly : (crc >> 1);
+            }
+            m_table[0][i] = crc;
+        }
+
+        for (int i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                uint64_t prev = m_table[k - 1][i];
+                m_table[k][i] = (prev >> 8) ^ m_table[0][prev & 0xff];
+            }
+        }
+    }
+
+    // crc为未取反的内部状态
+    uint64_t Update(uint64_t crc, const unsigned char* p, size_t len) const {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        while (len >= 8) {
+            uint64_t v = 0;
+            memcpy(&v, p, 8);
+            v ^= crc;
+            crc = m_table[7][v & 0xff] ^ m_table[6][(v >> 8) & 0xff]
+                ^ m_table[5][(v >> 16) & 0xff] ^ m_table[4][(v >> 24) & 0xff]
+                ^ m_table[3][(v >> 32) & 0xff] ^ m_table[2][(v >> 40) & 0xff]
+                ^ m_table[1][(v >> 48) & 0xff] ^ m_table[0][v >> 56];
+            p += 8;
+            len -= 8;
+        }
+#endif
+        while (len > 0) {
+            crc = m_table[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+            ++p;
+            --len;
+        }
+        return crc;
+    }
+
+private:
+    uint64_t m_table[8][256];
+};
+
+const Crc64Table& GetCrc64Table() {
+    static const Crc64Table table;
+    return table;
+}
+
+#ifdef COS_CRC64_USE_PCLMUL
+bool IsPclmulSupported() {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (ecx & bit_PCLMUL) != 0;
+}
+
+// 把128位的x向后折叠, 低64位乘x^(T+63) mod P, 高64位乘x^(T-1) mod P(均为按位反转的表示)
+__attribute__((target("pclmul,sse2")))
+inline __m128i Fold(__m128i x, __m128i k) {
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                         _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+// 8路并行, 每轮折叠128字节, 最后归约为16字节后查表得到CRC. 要求len >= 128
+__attribute__((target("pclmul,sse2")))
+uint64_t UpdatePclmul(uint64_t crc, const unsigned char* p, size_t len) {
+    // T = 1024 bit
+    const __m128i k1024 = _mm_set_epi64x(0xd7d86b2af73de740LL, 0x8757d71d4fcc1000LL);
+    // T = 128 bit
+    const __m128i k128 = _mm_set_epi64x(0xdabe95afc7875f40LL, 0xe05dd497ca393ae4LL);
+
+    __m128i x[8];
+    for (int i = 0; i < 8; ++i) {
+        x[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+    }
+    x[0] = _mm_xor_si128(x[0], _mm_cvtsi64_si128(static_cast<long long>(crc)));
+    p += 128;
+    len -= 128;
+
+    while (len >= 128) {
+        for (int i = 0; i < 8; ++i) {
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+            x[i] = _mm_xor_si128(Fold(x[i], k1024), y);
+        }
+        p += 128;
+        len -= 128;
+    }
+
+    __m128i acc = x[0];
+    for (int i = 1; i < 8; ++i) {
+        acc = _mm_xor_si128(Fold(acc, k128), x[i]);
+    }
+
+    while (len >= 16) {
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        acc = _mm_xor_si128(Fold(acc, k128), y);
+        p += 16;
+        len -= 16;
+    }
+
+    unsigned char folded[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(folded), acc);
+    const Crc64Table& table = GetCrc64Table();
+    crc = table.Update(0, folded, sizeof(folded));
+    return table.Update(crc, p, len);
+}
+#endif
+
+uint64_t Gf2MatrixTimes(const uint64_t* mat, uint64_t vec) {
+    uint64_t sum = 0;
+    while (vec) {
+        if (vec & 1) {
+            sum ^= *mat;
+        }
+        vec >>= 1;
+        ++mat;
+    }
+    return sum;
+}
+
+void Gf2MatrixSquare(uint64_t* square, const uint64_t* mat) {
+    for (int n = 0; n < 64; ++n) {
+        square[n] = Gf2MatrixTimes(mat, mat[n]);
+    }
+}
+
+} // namespace
+
+uint64_t Crc64::Calc(uint64_t crc, const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#ifdef COS_CRC64_USE_PCLMUL
+    static const bool is_pclmul_supported = IsPclmulSupported();
+    if (is_pclmul_supported && len >= kPclmulMinLen) {
+        return ~UpdatePclmul(crc, p, len);
+    }
+#endif
+    return ~GetCrc64Table().Update(crc, p, len);
+}
+
+// 与zlib的crc32_combine相同: 对crc1做len2个0字节的CRC运算(GF(2)矩阵平方加速), 再与crc2异或
+uint64_t Crc64::Combine(uint64_t crc1, uint64_t crc2, uint64_t len2) {
+    if (len2 == 0) {
+        return crc1;
+    }
+
+    uint64_t even[64];
+    uint64_t odd[64];
+
+    // 1个0 bit对应的运算矩阵
+    odd[0] = kCrc64Poly;
+    uint64_t row = 1;
+    for (int n = 1; n < 64; ++n) {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    // 2个0 bit
+    Gf2MatrixSquare(even, odd);
+    // 4个0 bit
+    Gf2MatrixSquare(odd, even);
+
+    // 第一次平方得到1个0字节(8个0 bit)
+    do {
+        Gf2MatrixSquare(even, odd);
+        if (len2 & 1) {
+            crc1 = Gf2MatrixTimes(even, crc1);
+        }
+        len2 >>= 1;
+        if (len2 == 0) {
+            break;
+        }
+
+        Gf2MatrixSquare(odd, even);
+        if (len2 & 1) {
+            crc1 = Gf2MatrixTimes(odd, crc1);
+        }
+        len2 >>= 1;
+    } while (len2 != 0);
+
+    return crc1 ^ crc2;
+}
+
+} // namespace qcloud_cos
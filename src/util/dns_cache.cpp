@@ -0,0 +1,89 @@
+#include "util/dns_cache.h"
+
+#include "Poco/Net/DNS.h"
+#include "Poco/Net/HostEntry.h"
+#include "Poco/Net/IPAddress.h"
+#include "Poco/Net/NetException.h"
+
+#include "cos_defines.h"
+#include "cos_sys_config.h"
+#include "util/http_sender.h"
+
+namespace qcloud_cos {
+
+DnsCache& DnsCache::Instance() {
+    static DnsCache* s_cache = new DnsCache();
+    return *s_cache;
+}
+
+uint64_t DnsCache::GetNowInMs() {
+    return HttpSender::GetTimeStampInUs() / 1000;
+}
+
+std::vector<std::string> DnsCache::Lookup(const std::string& host) {
+    std::vector<std::string> addrs;
+    try {
+        // hostByName使用getaddrinfo(AF_UNSPEC), 同时返回A和AAAA记录
+        const Poco::Net::HostEntry& entry = Poco::Net::DNS::hostByName(host);
+        const Poco::Net::HostEntry::AddressList& addr_list = entry.addresses();
+        for (Poco::Net::HostEntry::AddressList::const_iterator itr = addr_list.begin();
+             itr != addr_list.end(); ++itr) {
+            addrs.push_back(itr->toString());
+        }
+    } catch (const Poco::Exception& ex) {
+        SDK_LOG_WARN("Resolve host fail, host=%s, exception=%s",
+                     host.c_str(), ex.displayText().c_str());
+    }
+    return addrs;
+}
+
+std::string DnsCache::PickAddress(const std::string& host, DnsEntry* entry) {
+    if (entry->m_addrs.empty()) {
+        throw Poco::Net::HostNotFoundException(host);
+    }
+
+    return entry->m_addrs[entry->m_next_index++ % entry->m_addrs.size()];
+}
+
+std::string DnsCache::Resolve(const std::string& host) {
+    if (!CosSysConfig::IsUseDnsCache()) {
+        return host;
+    }
+
+    Poco::Net::IPAddress ip;
+    if (Poco::Net::IPAddress::tryParse(host, ip)) {
+        return host;
+    }
+
+    {
+        SimpleMutexLocker locker(&m_mutex);
+        std::map<std::string, DnsEntry>::iterator itr = m_entries.find(host);
+        if (itr != m_entries.end() && itr->second.m_expire_time_in_ms > GetNowInMs()) {
+            return PickAddress(host, &itr->second);
+        }
+    }
+
+    // 解析可能较慢, 不持锁; 并发请求同一个过期host时可能重复解析, 结果以最后一次为准
+    std::vector<std::string> addrs = Lookup(host);
+    uint64_t now_in_ms = GetNowInMs();
+
+    SimpleMutexLocker locker(&m_mutex);
+    DnsEntry& entry = m_entries[host];
+    entry.m_addrs = addrs;
+    if (addrs.empty()) {
+        entry.m_expire_time_in_ms = now_in_ms + CosSysConfig::GetDnsNegativeCacheTtlInms();
+    } else {
+        entry.m_expire_time_in_ms = now_in_ms + CosSysConfig::GetDnsCacheTtlInms();
+        SDK_LOG_DBG("Resolve host, host=%s, addr_count=%lu", host.c_str(), addrs.size());
+    }
+    // 起始位置随时间变化, 避免多个进程总是从同一个ip开始
+    entry.m_next_index = now_in_ms;
+    return PickAddress(host, &entry);
+}
+
+void DnsCache::Clear() {
+    SimpleMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+} // namespace qcloud_cos
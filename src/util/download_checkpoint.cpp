@@ -0,0 +1,142 @@
+#include "util/download_checkpoint.h"
+
+#include <unistd.h>
+
+#include <fstream>
+
+#include "json/json.h"
+
+#include "cos_sys_config.h"
+#include "util/codec_util.h"
+#include "util/file_util.h"
+#include "util/string_util.h"
+
+namespace qcloud_cos {
+
+void DownloadCheckpoint::Reset(const std::string& bucket_name, const std::string& object_name,
+                               const std::string& etag, uint64_t file_size, uint64_t slice_size) {
+    m_bucket_name = bucket_name;
+    m_object_name = object_name;
+    m_etag = etag;
+    m_file_size = file_size;
+    m_slice_size = slice_size;
+    uint64_t slice_num = slice_size == 0 ? 0 : (file_size + slice_size - 1) / slice_size;
+    m_slice_bitmap.assign(slice_num, false);
+    m_slice_crc64s.assign(slice_num, 0);
+}
+
+bool DownloadCheckpoint::Load(const std::string& checkpoint_file) {
+    std::ifstream is(checkpoint_file.c_str(), std::ios::in);
+    if (!is || !is.is_open()) {
+        return false;
+    }
+
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(is, root, false) || !root.isObject()) {
+        SDK_LOG_WARN("Parse download checkpoint fail, checkpoint_file=%s",
+                     checkpoint_file.c_str());
+        return false;
+    }
+
+    Reset(root["Bucket"].asString(), root["Key"].asString(), root["ETag"].asString(),
+          root["FileSize"].asUInt64(), root["SliceSize"].asUInt64());
+
+    // 位图以hex保存, 每个字节对应8个分片, 低位在前
+    std::string bitmap = CodecUtil::HexToBin(root["SliceBitmap"].asString());
+    if (bitmap.size() != (m_slice_bitmap.size() + 7) / 8) {
+        SDK_LOG_WARN("Download checkpoint bitmap is invalid, checkpoint_file=%s",
+                     checkpoint_file.c_str());
+        return false;
+    }
+    // 没有CRC64的分片(旧版本写入的checkpoint)无法参与整个对象的CRC64校验, 当作未下载
+    const Json::Value& crc64s = root["SliceCrc64s"];
+    for (size_t i = 0; i < m_slice_bitmap.size(); ++i) {
+        bool is_done = (static_cast<unsigned char>(bitmap[i / 8]) >> (i % 8)) & 1;
+        std::string crc64 = "";
+        if (is_done && crc64s.isArray() && i < crc64s.size()) {
+            crc64 = crc64s[static_cast<Json::Value::ArrayIndex>(i)].asString();
+        }
+        if (is_done && !crc64.empty()) {
+            m_slice_bitmap[i] = true;
+            m_slice_crc64s[i] = StringUtil::StringToUint64(crc64);
+        }
+    }
+    return true;
+}
+
+bool DownloadCheckpoint::Save(const std::string& checkpoint_file) const {
+    std::string bitmap((m_slice_bitmap.size() + 7) / 8, '\0');
+    for (size_t i = 0; i < m_slice_bitmap.size(); ++i) {
+        if (m_slice_bitmap[i]) {
+            bitmap[i / 8] = static_cast<char>(bitmap[i / 8] | (1 << (i % 8)));
+        }
+    }
+    std::vector<char> hex(bitmap.size() * 2 + 1, '\0');
+    if (!bitmap.empty()) {
+        CodecUtil::BinToHex(reinterpret_cast<const unsigned char*>(bitmap.data()),
+                            bitmap.size(), &hex[0]);
+    }
+
+    Json::Value root;
+    root["Bucket"] = m_bucket_name;
+    root["Key"] = m_object_name;
+    root["ETag"] = m_etag;
+    root["FileSize"] = Json::UInt64(m_file_size);
+    root["SliceSize"] = Json::UInt64(m_slice_size);
+    root["SliceBitmap"] = std::string(&hex[0], bitmap.size() * 2);
+
+    // CRC64以十进制字符串保存, 与x-cos-hash-crc64ecma的格式一致, 未下载的分片为空串
+    Json::Value crc64s(Json::arrayValue);
+    for (size_t i = 0; i < m_slice_crc64s.size(); ++i) {
+        crc64s.append(m_slice_bitmap[i] ? StringUtil::Uint64ToString(m_slice_crc64s[i]) : "");
+    }
+    root["SliceCrc64s"] = crc64s;
+
+    Json::FastWriter writer;
+    if (!FileUtil::AtomicWriteFile(checkpoint_file, writer.write(root))) {
+        SDK_LOG_WARN("Save download checkpoint fail, checkpoint_file=%s",
+                     checkpoint_file.c_str());
+        return false;
+    }
+    return true;
+}
+
+void DownloadCheckpoint::Remove(const std::string& checkpoint_file) {
+    unlink(checkpoint_file.c_str());
+}
+
+bool DownloadCheckpoint::IsSameDownload(const DownloadCheckpoint& other) const {
+    return m_bucket_name == other.m_bucket_name
+        && m_object_name == other.m_object_name
+        && m_etag == other.m_etag
+        && m_file_size == other.m_file_size
+        && m_slice_size == other.m_slice_size;
+}
+
+bool DownloadCheckpoint::IsSliceDone(uint64_t slice_index) const {
+    return slice_index < m_slice_bitmap.size() && m_slice_bitmap[slice_index];
+}
+
+void DownloadCheckpoint::SetSliceDone(uint64_t slice_index, uint64_t crc64) {
+    if (slice_index < m_slice_bitmap.size()) {
+        m_slice_bitmap[slice_index] = true;
+        m_slice_crc64s[slice_index] = crc64;
+    }
+}
+
+uint64_t DownloadCheckpoint::GetSliceCrc64(uint64_t slice_index) const {
+    return IsSliceDone(slice_index) ? m_slice_crc64s[slice_index] : 0;
+}
+
+uint64_t DownloadCheckpoint::GetDoneSliceNum() const {
+    uint64_t num = 0;
+    for (size_t i = 0; i < m_slice_bitmap.size(); ++i) {
+        if (m_slice_bitmap[i]) {
+            ++num;
+        }
+    }
+    return num;
+}
+
+} // namespace qcloud_cos
@@ -1,9 +1,18 @@
 #include "util/file_util.h"
 
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
+#include "Poco/DigestStream.h"
+#include "Poco/MD5Engine.h"
+#include "Poco/StreamCopier.h"
+
 #include "cos_defines.h"
 #include "cos_sys_config.h"
 #include "util/codec_util.h"
@@ -31,4 +40,62 @@ uint64_t FileUtil::GetFileLen(const std::string& local_file_path) {
     file_input.close();
     return file_len;
 }
+
+uint64_t FileUtil::GetFileMtime(const std::string& local_file_path) {
+    struct stat st;
+    if (stat(local_file_path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return st.st_mtime;
+}
+
+std::string FileUtil::GetFileMd5(const std::string& local_file_path) {
+    std::ifstream file_input(local_file_path.c_str(), std::ios::in | std::ios::binary);
+    if (!file_input.is_open()) {
+        return "";
+    }
+
+    Poco::MD5Engine md5;
+    Poco::DigestOutputStream dos(md5);
+    Poco::StreamCopier::copyStream(file_input, dos);
+    dos.close();
+    file_input.close();
+    return Poco::DigestEngine::digestToHex(md5.digest());
+}
+
+bool FileUtil::AtomicWriteFile(const std::string& path, const std::string& content) {
+    std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+
+    size_t offset = 0;
+    while (offset < content.size()) {
+        ssize_t ret = write(fd, content.data() + offset, content.size() - offset);
+        if (ret <= 0) {
+            break;
+        }
+        offset += ret;
+    }
+    // rename之前内容必须已落盘, 否则掉电后可能得到一个空的新文件
+    bool is_synced = (fsync(fd) == 0);
+    close(fd);
+
+    if (offset != content.size() || !is_synced
+        || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        unlink(tmp_path.c_str());
+        return false;
+    }
+
+    // rename本身记录在目录中, 同步目录后才能保证掉电后看到的是新文件
+    std::string::size_type pos = path.rfind('/');
+    std::string dir = (pos == std::string::npos) ? "." : (pos == 0 ? "/" : path.substr(0, pos));
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return true;
+}
 } //namespace qcloud_cos
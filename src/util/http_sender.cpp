@@ -7,19 +7,17 @@
 
 #include "util/http_sender.h"
 
+#include <errno.h>
+#include <stdio.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #include <iostream>
 #include <sstream>
 
-#include "boost/scoped_ptr.hpp"
-#include "Poco/DigestStream.h"
-#include "Poco/MD5Engine.h"
-#include "Poco/Net/Context.h"
 #include "Poco/Net/HTTPClientSession.h"
 #include "Poco/Net/HTTPRequest.h"
 #include "Poco/Net/HTTPResponse.h"
-#include "Poco/Net/HTTPSClientSession.h"
 #include "Poco/Net/NetException.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/URI.h"
@@ -28,9 +26,57 @@
 #include "cos_sys_config.h"
 #include "util/string_util.h"
 #include "util/codec_util.h"
+#include "util/crc64.h"
+#include "util/http_session_pool.h"
+#include "util/md5_tee_stream.h"
 
 namespace qcloud_cos {
 
+namespace {
+
+// 将响应body写入resp_stream, 写入的同时计算MD5, 读完后与etag比较.
+// body只经过一次, 不会在内存中缓存整个对象
+bool CopyStreamAndCheckMd5(std::istream& recv_stream, std::ostream& resp_stream,
+                           const std::string& etag, uint64_t* real_byte,
+                           std::string* err_msg) {
+    Md5TeeOutputStream tee(resp_stream);
+    *real_byte = Poco::StreamCopier::copyStream(recv_stream, tee);
+    tee.flush();
+
+    std::string md5_str = tee.GetMd5();
+    if (etag != md5_str) {
+        *err_msg = "Md5 of response body is not equal to the etag in the header."
+            " Body Md5= " + md5_str + ", etag=" + etag;
+        SDK_LOG_ERR("Check Md5 fail, %s", err_msg->c_str());
+        return false;
+    }
+    return true;
+}
+
+// 解析请求头中的"bytes=start-end"
+bool ParseRange(const std::string& range, uint64_t* start, uint64_t* end) {
+    unsigned long long s = 0, e = 0;
+    if (sscanf(range.c_str(), "bytes=%llu-%llu", &s, &e) != 2 || s > e) {
+        return false;
+    }
+    *start = s;
+    *end = e;
+    return true;
+}
+
+// 解析响应头中的"bytes start-end/total"
+bool ParseContentRange(const std::string& content_range, uint64_t* start, uint64_t* end) {
+    unsigned long long s = 0, e = 0;
+    if (sscanf(content_range.c_str(), "bytes %llu-%llu", &s, &e) != 2 || s > e) {
+        return false;
+    }
+    *start = s;
+    *end = e;
+    return true;
+}
+
+} // namespace
+
 int HttpSender::SendRequest(const std::string& http_method,
                             const std::string& url_str,
                             const std::map<std::string, std::string>& req_params,
@@ -123,43 +169,53 @@ int HttpSender::SendRequest(const std::string& http_method,
                             std::ostream& resp_stream,
                             std::string* err_msg,
                             bool is_check_md5) {
+    return SendRequest(http_method, url_str, req_params, req_headers, &is, NULL, 0,
+                       conn_timeout_in_ms, recv_timeout_in_ms, resp_headers,
+                       resp_stream, err_msg, is_check_md5);
+}
+
+int HttpSender::SendRequest(const std::string& http_method,
+                            const std::string& url_str,
+                            const std::map<std::string, std::string>& req_params,
+                            const std::map<std::string, std::string>& req_headers,
+                            const unsigned char* req_body_buf,
+                            size_t req_body_len,
+                            uint64_t conn_timeout_in_ms,
+                            uint64_t recv_timeout_in_ms,
+                            std::map<std::string, std::string>* resp_headers,
+                            std::string* resp_body,
+                            std::string* err_msg,
+                            bool is_check_md5) {
+    std::ostringstream oss;
+    int ret = SendRequest(http_method, url_str, req_params, req_headers, NULL,
+                          req_body_buf, req_body_len, conn_timeout_in_ms,
+                          recv_timeout_in_ms, resp_headers, oss, err_msg, is_check_md5);
+    *resp_body = oss.str();
+    return ret;
+}
+
+int HttpSender::SendRequest(const std::string& http_method,
+                            const std::string& url_str,
+                            const std::map<std::string, std::string>& req_params,
+                            const std::map<std::string, std::string>& req_headers,
+                            std::istream* is,
+                            const unsigned char* req_body_buf,
+                            size_t req_body_len,
+                            uint64_t conn_timeout_in_ms,
+                            uint64_t recv_timeout_in_ms,
+                            std::map<std::string, std::string>* resp_headers,
+                            std::ostream& resp_stream,
+                            std::string* err_msg,
+                            bool is_check_md5) {
     Poco::Net::HTTPResponse res;
     try {
         Poco::URI url(url_str);
-        boost::scoped_ptr<Poco::Net::HTTPClientSession> session;
-        if (StringUtil::StringStartsWithIgnoreCase(url_str, "https")) {
-            Poco::Net::Context::Ptr context = new Poco::Net::Context(Poco::Net::Context::CLIENT_USE,
-                                                     "", "", "", Poco::Net::Context::VERIFY_RELAXED,
-                                                     9, true, "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
-            session.reset(new Poco::Net::HTTPSClientSession(url.getHost(), url.getPort(), context));
-        } else {
-            session.reset(new Poco::Net::HTTPClientSession(url.getHost(), url.getPort()));
-        }
+        bool is_https = StringUtil::StringStartsWithIgnoreCase(url_str, "https");
+        HttpSessionGuard session(is_https, url.getHost(), url.getPort(), conn_timeout_in_ms);
 
         session->setTimeout(Poco::Timespan(0, conn_timeout_in_ms * 1000));
         // 1. 拼接path_query字符串
-        std::string path = url.getPath();
-        if (path.empty()) {
-            path += "/";
-        }
-
-        std::string query_str;
-        for (std::map<std::string, std::string>::const_iterator c_itr = req_params.begin();
-                c_itr != req_params.end(); ++c_itr) {
-            std::string part;
-            if (c_itr->second.empty()) {
-                part = CodecUtil::UrlEncode(c_itr->first) + "&";
-            } else {
-                part = CodecUtil::UrlEncode(c_itr->first) + "=" + CodecUtil::UrlEncode(c_itr->second) + "&";
-            }
-            query_str += part;
-        }
-
-        if (!query_str.empty()) {
-            query_str = "?" + query_str.substr(0, query_str.size() - 1);
-        }
-        std::string path_and_query_str = CodecUtil::EncodeKey(path) + query_str;
-        //std::string path_and_query_str = CodecUtil::EncodeKey(path) + CodecUtil::UrlEncode("?response-content-type") + "= " + CodecUtil::UrlEncode("abcd\r\rnef");
+        std::string path_and_query_str = GetPathAndQuery(url.getPath(), req_params);
 
         // 2. 创建http request, 并填充头部
         Poco::Net::HTTPRequest req(http_method, path_and_query_str, Poco::Net::HTTPMessage::HTTP_1_1);
@@ -168,11 +224,26 @@ int HttpSender::SendRequest(const std::string& http_method,
             req.add(c_itr->first, (c_itr->second).c_str());
         }
 
-        // 3. 计算长度
-        std::streampos pos = is.tellg();
-        is.seekg(0, std::ios::end);
-        req.setContentLength(is.tellg());
-        is.seekg(pos);
+        // 3. 计算长度, 无法seek的流(管道、socket等)使用chunked编码边读边发
+        if (is != NULL) {
+            std::streampos pos = is->tellg();
+            std::streampos end_pos = -1;
+            if (pos != std::streampos(-1)) {
+                is->seekg(0, std::ios::end);
+                end_pos = is->tellg();
+                is->clear();
+                is->seekg(pos);
+            }
+
+            if (end_pos != std::streampos(-1)) {
+                req.setContentLength(end_pos - pos);
+            } else {
+                is->clear();
+                req.setChunkedTransferEncoding(true);
+            }
+        } else {
+            req.setContentLength(req_body_len);
+        }
 
 #ifdef __COS_DEBUG__
         std::ostringstream debug_os;
@@ -180,9 +251,13 @@ int HttpSender::SendRequest(const std::string& http_method,
         SDK_LOG_DBG("request=[%s]", debug_os.str().c_str());
 #endif
 
-        // 4. 发送请求
+        // 4. 发送请求, 内存中的body直接写入连接, 不再经过中间拷贝
         std::ostream& os = session->sendRequest(req);
-        Poco::StreamCopier::copyStream(is, os);
+        if (is != NULL) {
+            Poco::StreamCopier::copyStream(*is, os);
+        } else if (req_body_len > 0) {
+            os.write(reinterpret_cast<const char*>(req_body_buf), req_body_len);
+        }
 
         // 5. 接收返回
         Poco::Net::StreamSocket& ss = session->socket();
@@ -203,33 +278,10 @@ int HttpSender::SendRequest(const std::string& http_method,
         if (is_check_md5 && !StringUtil::IsV4ETag(etag)
             && !StringUtil::IsMultipartUploadETag(etag)) {
             SDK_LOG_DBG("Check Response Md5");
-            Poco::MD5Engine md5;
-            Poco::DigestOutputStream dos(md5);
-
-            // explicit iostream (streambuf* sb);
-            std::stringbuf ibuf;
-            std::iostream io_tmp(&ibuf);
-
-            // The Poco session->receiveResponse return the streambuf which dose not overload the base_iostream seekpos which is the realization of the tellg and seekg.
-            // It casue the recv_stream can not relocation the begin postion, so can not reuse of the recv_stream.
-            // FIXME it might has property issue.
-            Poco::StreamCopier::copyStream(recv_stream, io_tmp);
-
-            std::streampos pos = io_tmp.tellg();
-            Poco::StreamCopier::copyStream(io_tmp, dos);
-            io_tmp.clear();
-            io_tmp.seekg(pos);
-            dos.close();
-
-            std::string md5_str = Poco::DigestEngine::digestToHex(md5.digest());
-
-            if (etag != md5_str) {
-                *err_msg = "Md5 of response body is not equal to the etag in the header."
-                    " Body Md5= " + md5_str + ", etag=" + etag;
-                SDK_LOG_ERR("Check Md5 fail, %s", err_msg->c_str());
+            uint64_t real_byte = 0;
+            if (!CopyStreamAndCheckMd5(recv_stream, resp_stream, etag, &real_byte, err_msg)) {
                 ret = -1;
             }
-            Poco::StreamCopier::copyStream(io_tmp, resp_stream);
         }else {
             Poco::StreamCopier::copyStream(recv_stream, resp_stream);
         }
@@ -241,6 +293,8 @@ int HttpSender::SendRequest(const std::string& http_method,
             SDK_LOG_DBG("key=[%s], value=[%s]\n", itr->first.c_str(), itr->second.c_str());
         }
 #endif
+        // 响应已完整读取, 服务端允许keep-alive时连接可放回连接池
+        session.SetReusable(res.getKeepAlive());
         SDK_LOG_INFO("Send request over, status=%d, reason=%s",
                 res.getStatus(), res.getReason().c_str());
         return ret;
@@ -277,40 +331,11 @@ int HttpSender::SendRequest(const std::string& http_method,
     Poco::Net::HTTPResponse res;
     try {
         Poco::URI url(url_str);
-        boost::scoped_ptr<Poco::Net::HTTPClientSession> session;
-        if (StringUtil::StringStartsWithIgnoreCase(url_str, "https")) {
-            Poco::Net::Context::Ptr context = new Poco::Net::Context(Poco::Net::Context::CLIENT_USE,
-                                                     "", "", "", Poco::Net::Context::VERIFY_RELAXED,
-                                                     9, true, "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
-            session.reset(new Poco::Net::HTTPSClientSession(url.getHost(), url.getPort(), context));
-        } else {
-            session.reset(new Poco::Net::HTTPClientSession(url.getHost(), url.getPort()));
-        }
+        bool is_https = StringUtil::StringStartsWithIgnoreCase(url_str, "https");
+        HttpSessionGuard session(is_https, url.getHost(), url.getPort(), conn_timeout_in_ms);
         session->setTimeout(Poco::Timespan(0, conn_timeout_in_ms * 1000));
         // 1. 拼接path_query字符串
-        std::string path = url.getPath();
-        if (path.empty()) {
-            path += "/";
-        }
-
-        std::string query_str;
-        for (std::map<std::string, std::string>::const_iterator c_itr = req_params.begin();
-                c_itr != req_params.end(); ++c_itr) {
-            std::string part;
-            if (c_itr->second.empty()) {
-                part = CodecUtil::UrlEncode(c_itr->first) + "&";
-            } else {
-                part = CodecUtil::UrlEncode(c_itr->first) + "=" + CodecUtil::UrlEncode(c_itr->second) + "&";
-            }
-            query_str += part;
-        }
-
-        if (!query_str.empty()) {
-            query_str = "?" + query_str.substr(0, query_str.size() - 1);
-        }
-        // std::string path_and_query_str = CodecUtil::EncodeKey(path) + CodecUtil::UrlEncode(query_str);
-        std::string path_and_query_str = CodecUtil::EncodeKey(path) + query_str;
-        //std::string path_and_query_str = CodecUtil::EncodeKey(path) + "response-content-type=abcd%0A%0Def";
+        std::string path_and_query_str = GetPathAndQuery(url.getPath(), req_params);
 
         // 2. 创建http request, 并填充头部
         Poco::Net::HTTPRequest req(http_method, path_and_query_str, Poco::Net::HTTPMessage::HTTP_1_1);
@@ -353,32 +378,9 @@ int HttpSender::SendRequest(const std::string& http_method,
             if (is_check_md5 && !StringUtil::IsV4ETag(etag)
                 && !StringUtil::IsMultipartUploadETag(etag)) {
                 SDK_LOG_DBG("Check Response Md5");
-                Poco::MD5Engine md5;
-                Poco::DigestOutputStream dos(md5);
-
-                // explicit iostream (streambuf* sb);
-                std::stringbuf ibuf;
-                std::iostream io_tmp(&ibuf);
-
-                // The Poco session->receiveResponse return the streambuf which dose not overload the base_iostream seekpos which is the realization of the tellg and seekg.
-                // It casue the recv_stream can not relocation the begin postion, so can not reuse of the recv_stream.
-                // FIXME it might has property issue.
-                *real_byte = Poco::StreamCopier::copyStream(recv_stream, io_tmp);
-
-                std::streampos pos = io_tmp.tellg();
-                Poco::StreamCopier::copyStream(io_tmp, dos);
-                io_tmp.clear();
-                io_tmp.seekg(pos);
-                dos.close();
-                std::string md5_str = Poco::DigestEngine::digestToHex(md5.digest());
-
-                if (etag != md5_str) {
-                    *err_msg = "Md5 of response body is not equal to the etag in the header."
-                        " Body Md5= " + md5_str + ", etag=" + etag;
-                    SDK_LOG_ERR("Check Md5 fail, %s", err_msg->c_str());
-                    ret = -1;
+                if (!CopyStreamAndCheckMd5(recv_stream, resp_stream, etag, real_byte, err_msg)) {
+                    ret = kHttpCodeMd5Mismatch;
                 }
-                Poco::StreamCopier::copyStream(io_tmp, resp_stream);
             }else { // other way direct use the recv_stream
                 *real_byte = Poco::StreamCopier::copyStream(recv_stream, resp_stream);
             }
@@ -392,6 +394,225 @@ int HttpSender::SendRequest(const std::string& http_method,
             SDK_LOG_DBG("key=[%s], value=[%s]\n", itr->first.c_str(), itr->second.c_str());
         }
 #endif
+        session.SetReusable(res.getKeepAlive());
+        SDK_LOG_INFO("Send request over, status=%d, reason=%s", ret, res.getReason().c_str());
+        return ret;
+    } catch (Poco::Net::NetException& ex){
+        SDK_LOG_ERR("Net Exception:%s", ex.displayText().c_str());
+        *err_msg = "Net Exception:" + ex.displayText();
+        return -1;
+    } catch (Poco::TimeoutException& ex) {
+        SDK_LOG_ERR("TimeoutException:%s", ex.displayText().c_str());
+        *err_msg = "TimeoutException:" + ex.displayText();
+        return -1;
+    } catch (const std::exception &ex) {
+        SDK_LOG_ERR("Exception:%s, errno=%d", std::string(ex.what()).c_str(), errno);
+        *err_msg = "Exception:" + std::string(ex.what());
+        return -1;
+    }
+
+    return res.getStatus();
+}
+
+int HttpSender::SendRequest(const std::string& http_method,
+                            const std::string& url_str,
+                            const std::map<std::string, std::string>& req_params,
+                            const std::map<std::string, std::string>& req_headers,
+                            const std::string& req_body,
+                            uint64_t conn_timeout_in_ms,
+                            uint64_t recv_timeout_in_ms,
+                            std::map<std::string, std::string>* resp_headers,
+                            unsigned char* resp_buf,
+                            size_t resp_buf_len,
+                            size_t* real_len,
+                            std::string* resp_body,
+                            std::string* err_msg,
+                            uint64_t* body_crc64) {
+    return SendRequest(http_method, url_str, req_params, req_headers, req_body,
+                       conn_timeout_in_ms, recv_timeout_in_ms, resp_headers,
+                       resp_buf, resp_buf_len, -1, 0, real_len, resp_body, err_msg,
+                       body_crc64);
+}
+
+int HttpSender::SendRequest(const std::string& http_method,
+                            const std::string& url_str,
+                            const std::map<std::string, std::string>& req_params,
+                            const std::map<std::string, std::string>& req_headers,
+                            const std::string& req_body,
+                            uint64_t conn_timeout_in_ms,
+                            uint64_t recv_timeout_in_ms,
+                            std::map<std::string, std::string>* resp_headers,
+                            int fd,
+                            uint64_t fd_offset,
+                            size_t* real_len,
+                            std::string* resp_body,
+                            std::string* err_msg,
+                            uint64_t* body_crc64) {
+    return SendRequest(http_method, url_str, req_params, req_headers, req_body,
+                       conn_timeout_in_ms, recv_timeout_in_ms, resp_headers,
+                       NULL, 0, fd, fd_offset, real_len, resp_body, err_msg,
+                       body_crc64);
+}
+
+int HttpSender::SendRequest(const std::string& http_method,
+                            const std::string& url_str,
+                            const std::map<std::string, std::string>& req_params,
+                            const std::map<std::string, std::string>& req_headers,
+                            const std::string& req_body,
+                            uint64_t conn_timeout_in_ms,
+                            uint64_t recv_timeout_in_ms,
+                            std::map<std::string, std::string>* resp_headers,
+                            unsigned char* resp_buf,
+                            size_t resp_buf_len,
+                            int fd,
+                            uint64_t fd_offset,
+                            size_t* real_len,
+                            std::string* resp_body,
+                            std::string* err_msg,
+                            uint64_t* body_crc64) {
+    Poco::Net::HTTPResponse res;
+    *real_len = 0;
+    try {
+        Poco::URI url(url_str);
+        bool is_https = StringUtil::StringStartsWithIgnoreCase(url_str, "https");
+        HttpSessionGuard session(is_https, url.getHost(), url.getPort(), conn_timeout_in_ms);
+        session->setTimeout(Poco::Timespan(0, conn_timeout_in_ms * 1000));
+        // 1. 拼接path_query字符串
+        std::string path_and_query_str = GetPathAndQuery(url.getPath(), req_params);
+
+        // 2. 创建http request, 并填充头部
+        Poco::Net::HTTPRequest req(http_method, path_and_query_str, Poco::Net::HTTPMessage::HTTP_1_1);
+        for (std::map<std::string, std::string>::const_iterator c_itr = req_headers.begin();
+                c_itr != req_headers.end(); ++c_itr) {
+            req.add(c_itr->first, (c_itr->second).c_str());
+        }
+        req.setContentLength(req_body.size());
+
+#ifdef __COS_DEBUG__
+        std::ostringstream debug_os;
+        req.write(debug_os);
+        SDK_LOG_DBG("request=[%s]", debug_os.str().c_str());
+#endif
+
+        // 3. 发送请求
+        std::ostream& os = session->sendRequest(req);
+        if (!req_body.empty()) {
+            os << req_body;
+        }
+
+        // 4. 接收返回
+        Poco::Net::StreamSocket& ss = session->socket();
+        ss.setReceiveTimeout(Poco::Timespan(0, recv_timeout_in_ms * 1000));
+        std::istream& recv_stream = session->receiveResponse(res);
+
+        int ret = res.getStatus();
+        resp_headers->insert(res.begin(), res.end());
+        if (ret < 200 || ret >= 300) {
+            Poco::StreamCopier::copyToString(recv_stream, *resp_body);
+            session.SetReusable(res.getKeepAlive());
+            SDK_LOG_INFO("Send request over, status=%d, reason=%s", ret, res.getReason().c_str());
+            return ret;
+        }
+
+        // 5. 校验返回的长度和范围, 不一致时不读取body, 连接也不再复用
+        if (!res.hasContentLength()) {
+            *err_msg = "Response missing Content-Length.";
+            SDK_LOG_ERR("%s", err_msg->c_str());
+            return -1;
+        }
+        uint64_t content_length = res.getContentLength64();
+
+        std::map<std::string, std::string>::const_iterator range_itr = req_headers.find("Range");
+        uint64_t range_start = 0, range_end = 0;
+        if (range_itr != req_headers.end()
+            && ParseRange(range_itr->second, &range_start, &range_end)) {
+            uint64_t start = 0, end = 0;
+            bool is_range_valid = false;
+            if (ret == 206) {
+                is_range_valid = res.has("Content-Range")
+                    && ParseContentRange(res.get("Content-Range"), &start, &end)
+                    && start == range_start && end <= range_end
+                    && end - start + 1 == content_length;
+            } else {
+                // 服务端忽略Range时返回整个对象, 只有从0开始的请求可以接受
+                is_range_valid = range_start == 0 && content_length <= range_end + 1;
+            }
+
+            if (!is_range_valid) {
+                *err_msg = "Response range mismatch, request range=" + range_itr->second
+                    + ", content-length=" + StringUtil::Uint64ToString(content_length);
+                SDK_LOG_ERR("%s", err_msg->c_str());
+                return -1;
+            }
+        }
+
+        if (fd < 0 && content_length > resp_buf_len) {
+            *err_msg = "Response body is larger than buffer, content-length="
+                + StringUtil::Uint64ToString(content_length);
+            SDK_LOG_ERR("%s", err_msg->c_str());
+            return -1;
+        }
+
+        // 6. 读取body, 直接写入目标buffer或者文件, 需要时对刚读到的数据计算CRC64
+        uint64_t received = 0;
+        uint64_t crc64 = 0;
+        if (fd < 0) {
+            while (received < content_length) {
+                size_t want = MIN(64 * 1024, content_length - received);
+                char* dst = reinterpret_cast<char*>(resp_buf) + received;
+                recv_stream.read(dst, want);
+                size_t got = recv_stream.gcount();
+                if (got == 0) {
+                    break;
+                }
+                if (body_crc64 != NULL) {
+                    crc64 = Crc64::Calc(crc64, dst, got);
+                }
+                received += got;
+            }
+        } else {
+            char buf[64 * 1024];
+            while (received < content_length) {
+                size_t want = MIN(sizeof(buf), content_length - received);
+                recv_stream.read(buf, want);
+                size_t got = recv_stream.gcount();
+                if (got == 0) {
+                    break;
+                }
+                if (body_crc64 != NULL) {
+                    crc64 = Crc64::Calc(crc64, buf, got);
+                }
+
+                size_t written = 0;
+                while (written < got) {
+                    ssize_t w = pwrite(fd, buf + written, got - written,
+                                       fd_offset + received + written);
+                    if (w < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        *err_msg = "pwrite fail, errno=" + StringUtil::IntToString(errno);
+                        SDK_LOG_ERR("%s", err_msg->c_str());
+                        return -1;
+                    }
+                    written += w;
+                }
+                received += got;
+            }
+        }
+        *real_len = received;
+        if (body_crc64 != NULL) {
+            *body_crc64 = crc64;
+        }
+
+        if (received != content_length) {
+            *err_msg = "Response body is incomplete, expect=" + StringUtil::Uint64ToString(content_length)
+                + ", received=" + StringUtil::Uint64ToString(received);
+            SDK_LOG_ERR("%s", err_msg->c_str());
+            return -1;
+        }
+
+        session.SetReusable(res.getKeepAlive());
         SDK_LOG_INFO("Send request over, status=%d, reason=%s", ret, res.getReason().c_str());
         return ret;
     } catch (Poco::Net::NetException& ex){
@@ -410,6 +631,31 @@ int HttpSender::SendRequest(const std::string& http_method,
 
     return res.getStatus();
 }
+
+std::string HttpSender::GetPathAndQuery(const std::string& path,
+                                        const std::map<std::string, std::string>& req_params) {
+    std::string query_str;
+    for (std::map<std::string, std::string>::const_iterator c_itr = req_params.begin();
+            c_itr != req_params.end(); ++c_itr) {
+        std::string part;
+        if (c_itr->second.empty()) {
+            part = CodecUtil::UrlEncode(c_itr->first) + "&";
+        } else {
+            part = CodecUtil::UrlEncode(c_itr->first) + "=" + CodecUtil::UrlEncode(c_itr->second) + "&";
+        }
+        query_str += part;
+    }
+
+    if (!query_str.empty()) {
+        query_str = "?" + query_str.substr(0, query_str.size() - 1);
+    }
+
+    if (path.empty()) {
+        return "/" + query_str;
+    }
+    return CodecUtil::EncodeKey(path) + query_str;
+}
+
 // TODO(sevenyou) 挪走
 uint64_t HttpSender::GetTimeStampInUs() {
     // 构造时间
@@ -0,0 +1,306 @@
+#include "util/http_session_pool.h"
+
+#include "Poco/Exception.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPSClientSession.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/SecureStreamSocket.h"
+#include "boost/thread/thread_time.hpp"
+
+#include "cos_defines.h"
+#include "cos_sys_config.h"
+#include "util/dns_cache.h"
+#include "util/http_sender.h"
+#include "util/socket_options.h"
+#include "util/ssl_context_cache.h"
+#include "util/tls_session_cache.h"
+#include "util/string_util.h"
+
+namespace qcloud_cos {
+
+namespace {
+
+// 在connect之前创建socket并按配置设置参数, 收发缓冲区大小才能在三次握手时
+// 参与窗口扩大因子的协商
+class CosHttpClientSession : public Poco::Net::HTTPClientSession {
+public:
+    CosHttpClientSession(const std::string& host, uint16_t port)
+        : Poco::Net::HTTPClientSession(host, port) {}
+
+protected:
+    virtual void connect(const Poco::Net::SocketAddress& address) {
+        Poco::Net::StreamSocket tcp_socket(address.family());
+        SocketOptions::Apply(tcp_socket);
+        // socket已创建, 基类connect直接在其上发起连接
+        attachSocket(tcp_socket);
+        Poco::Net::HTTPClientSession::connect(address);
+    }
+};
+
+// 直接连接解析好的ip, SNI和证书校验仍然使用域名.
+// 先建立并设置好tcp连接, 再在其上完成tls握手
+class CosHttpsClientSession : public Poco::Net::HTTPSClientSession {
+public:
+    CosHttpsClientSession(const std::string& host, const std::string& address, uint16_t port,
+                          Poco::Net::Context::Ptr context,
+                          Poco::Net::Session::Ptr tls_session)
+        : Poco::Net::HTTPSClientSession(address, port, context, tls_session),
+          m_host(host), m_tls_session(tls_session) {}
+
+    /// 当前连接的tls会话, tls1.3的会话票据在握手之后才下发, 因此在归还连接时获取
+    Poco::Net::Session::Ptr GetTlsSession() {
+        if (!connected()) {
+            return m_tls_session;
+        }
+        Poco::Net::SecureStreamSocket secure_socket(socket());
+        return secure_socket.currentSession();
+    }
+
+protected:
+    virtual void connect(const Poco::Net::SocketAddress& address) {
+        Poco::Net::StreamSocket tcp_socket(address.family());
+        SocketOptions::Apply(tcp_socket);
+        tcp_socket.connect(address, getTimeout());
+        tcp_socket.setReceiveTimeout(getTimeout());
+        tcp_socket.setSendTimeout(getTimeout());
+        tcp_socket.setNoDelay(true);
+
+        // 复用的会话由之前的连接握手时Poco创建, attach内通过useSession设置到新连接上
+        Poco::Net::SecureStreamSocket secure_socket = Poco::Net::SecureStreamSocket::attach(
+            tcp_socket, m_host, context(), m_tls_session);
+        m_tls_session = secure_socket.currentSession();
+        attachSocket(secure_socket);
+    }
+
+private:
+    std::string m_host;
+    Poco::Net::Session::Ptr m_tls_session;
+};
+
+} // namespace
+
+HttpSessionPool& HttpSessionPool::Instance() {
+    // 不在进程退出时析构, 避免与Poco/OpenSSL的全局对象析构顺序冲突,
+    // 空闲连接由CosAPI在最后一个实例析构时调用Clear关闭
+    static HttpSessionPool* s_pool = new HttpSessionPool();
+    return *s_pool;
+}
+
+std::string HttpSessionPool::GetEndpointKey(bool is_https, const std::string& host,
+                                            uint16_t port) {
+    std::string key = is_https ? "https://" : "http://";
+    return key + host + ":" + StringUtil::IntToString(port);
+}
+
+uint64_t HttpSessionPool::GetNowInMs() {
+    return HttpSender::GetTimeStampInUs() / 1000;
+}
+
+Poco::Net::HTTPClientSession* HttpSessionPool::CreateSession(bool is_https,
+                                                             const std::string& host,
+                                                             uint16_t port) {
+    // 连接使用缓存的解析结果, 多个ip时每个新连接轮询选取;
+    // 请求中的Host头由调用方设置, 不依赖session的host
+    std::string address = DnsCache::Instance().Resolve(host);
+
+    Poco::Net::HTTPClientSession* session = NULL;
+    if (is_https) {
+        session = new CosHttpsClientSession(host, address, port,
+                                            SslContextCache::GetClientContext(),
+                                            TlsSessionCache::Instance().GetPocoSession(host, port));
+    } else {
+        session = new CosHttpClientSession(address, port);
+    }
+
+    if (CosSysConfig::IsUseConnectionPool()) {
+        session->setKeepAlive(true);
+        uint64_t idle_timeout_in_ms = CosSysConfig::GetConnectionIdleTimeoutInms();
+        session->setKeepAliveTimeout(Poco::Timespan(0, idle_timeout_in_ms * 1000));
+    }
+    return session;
+}
+
+bool HttpSessionPool::IsSessionHealthy(Poco::Net::HTTPClientSession* session) {
+    try {
+        Poco::Net::StreamSocket& ss = session->socket();
+        if (ss.impl() == NULL || !ss.impl()->initialized()) {
+            return false;
+        }
+
+        if (ss.poll(Poco::Timespan(0), Poco::Net::Socket::SELECT_READ
+                    | Poco::Net::Socket::SELECT_ERROR)) {
+            return false;
+        }
+    } catch (const Poco::Exception& ex) {
+        SDK_LOG_DBG("Check idle session fail, exception=%s", ex.displayText().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void HttpSessionPool::SaveTlsSession(const std::string& host, uint16_t port,
+                                     Poco::Net::HTTPClientSession* session) {
+    CosHttpsClientSession* https_session = dynamic_cast<CosHttpsClientSession*>(session);
+    if (https_session == NULL) {
+        return;
+    }
+
+    try {
+        TlsSessionCache::Instance().Put(host, port, https_session->GetTlsSession());
+    } catch (const Poco::Exception& ex) {
+        SDK_LOG_DBG("Get tls session fail, exception=%s", ex.displayText().c_str());
+    }
+}
+
+void HttpSessionPool::EvictExpired(IdleSessionList* idle_list, uint64_t now_in_ms) {
+    uint64_t idle_timeout_in_ms = CosSysConfig::GetConnectionIdleTimeoutInms();
+    // 链表头部是最早归还的连接
+    while (!idle_list->empty()) {
+        const IdleSession& idle = idle_list->front();
+        if (now_in_ms - idle.m_last_used_in_ms < idle_timeout_in_ms) {
+            break;
+        }
+        delete idle.m_session;
+        idle_list->pop_front();
+    }
+}
+
+Poco::Net::HTTPClientSession* HttpSessionPool::Acquire(bool is_https,
+                                                       const std::string& host,
+                                                       uint16_t port,
+                                                       uint64_t wait_timeout_in_ms) {
+    std::string key = GetEndpointKey(is_https, host, port);
+    boost::system_time deadline = boost::get_system_time()
+        + boost::posix_time::milliseconds(wait_timeout_in_ms);
+
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (true) {
+        bool use_pool = CosSysConfig::IsUseConnectionPool();
+        IdleSessionList& idle_list = m_idle_sessions[key];
+        if (use_pool) {
+            EvictExpired(&idle_list, GetNowInMs());
+        }
+
+        if (use_pool && !idle_list.empty()) {
+            // 优先复用最近归还的连接, 健康检查期间连接计入使用中
+            Poco::Net::HTTPClientSession* session = idle_list.back().m_session;
+            idle_list.pop_back();
+            ++m_active_counts[key];
+            lock.unlock();
+
+            // 健康检查不需要持锁
+            if (IsSessionHealthy(session)) {
+                SDK_LOG_DBG("Reuse idle session, endpoint=%s", key.c_str());
+                return session;
+            }
+
+            delete session;
+            lock.lock();
+            --m_active_counts[key];
+            m_cond.notify_all();
+            continue;
+        }
+
+        unsigned& active_count = m_active_counts[key];
+        unsigned max_connections = CosSysConfig::GetMaxConnectionsPerHost();
+        if (!use_pool || max_connections == 0
+            || active_count + idle_list.size() < max_connections) {
+            ++active_count;
+            break;
+        }
+
+        // 连接数已达上限, 等待其他请求归还或关闭连接
+        SDK_LOG_DBG("Connections reach limit, wait for release, endpoint=%s, active=%u",
+                    key.c_str(), active_count);
+        if (!m_cond.timed_wait(lock, deadline)) {
+            throw Poco::TimeoutException("Wait for connection timeout, endpoint=" + key);
+        }
+    }
+    lock.unlock();
+
+    try {
+        return CreateSession(is_https, host, port);
+    } catch (...) {
+        lock.lock();
+        --m_active_counts[key];
+        m_cond.notify_all();
+        throw;
+    }
+}
+
+void HttpSessionPool::Release(bool is_https, const std::string& host, uint16_t port,
+                              Poco::Net::HTTPClientSession* session, bool reusable) {
+    if (session == NULL) {
+        return;
+    }
+
+    // 记录本次握手得到的TLS会话, 后续新建连接时复用
+    if (is_https) {
+        SaveTlsSession(host, port, session);
+    }
+
+    std::string key = GetEndpointKey(is_https, host, port);
+    uint64_t now_in_ms = GetNowInMs();
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    unsigned& active_count = m_active_counts[key];
+    if (active_count > 0) {
+        --active_count;
+    }
+    m_cond.notify_all();
+
+    if (!reusable || !CosSysConfig::IsUseConnectionPool()) {
+        delete session;
+        return;
+    }
+
+    IdleSessionList& idle_list = m_idle_sessions[key];
+    EvictExpired(&idle_list, now_in_ms);
+    // 运行时调小了上限时, 多出的连接直接关闭; 上限为0时不限制
+    unsigned max_connections = CosSysConfig::GetMaxConnectionsPerHost();
+    if (max_connections != 0 && active_count + idle_list.size() >= max_connections) {
+        delete session;
+        return;
+    }
+
+    IdleSession idle;
+    idle.m_session = session;
+    idle.m_last_used_in_ms = now_in_ms;
+    idle_list.push_back(idle);
+}
+
+void HttpSessionPool::Clear() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (std::map<std::string, IdleSessionList>::iterator itr = m_idle_sessions.begin();
+         itr != m_idle_sessions.end(); ++itr) {
+        for (IdleSessionList::iterator s_itr = itr->second.begin();
+             s_itr != itr->second.end(); ++s_itr) {
+            delete s_itr->m_session;
+        }
+    }
+    m_idle_sessions.clear();
+    m_cond.notify_all();
+}
+
+size_t HttpSessionPool::GetIdleCount() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    size_t count = 0;
+    for (std::map<std::string, IdleSessionList>::const_iterator itr = m_idle_sessions.begin();
+         itr != m_idle_sessions.end(); ++itr) {
+        count += itr->second.size();
+    }
+    return count;
+}
+
+size_t HttpSessionPool::GetActiveCount() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    size_t count = 0;
+    for (std::map<std::string, unsigned>::const_iterator itr = m_active_counts.begin();
+         itr != m_active_counts.end(); ++itr) {
+        count += itr->second;
+    }
+    return count;
+}
+
+} // namespace qcloud_cos
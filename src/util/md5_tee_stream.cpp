@@ -0,0 +1,94 @@
+#include "util/md5_tee_stream.h"
+
+namespace qcloud_cos {
+
+int DigestTeeStreamBuf::overflow(int c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+        return traits_type::not_eof(c);
+    }
+
+    char ch = traits_type::to_char_type(c);
+    if (traits_type::eq_int_type(m_sink->sputc(ch), traits_type::eof())) {
+        return traits_type::eof();
+    }
+    m_engine->update(&ch, 1);
+    return c;
+}
+
+std::streamsize DigestTeeStreamBuf::xsputn(const char* s, std::streamsize n) {
+    std::streamsize written = m_sink->sputn(s, n);
+    if (written > 0) {
+        m_engine->update(s, static_cast<size_t>(written));
+    }
+    return written;
+}
+
+int DigestTeeStreamBuf::sync() {
+    return m_sink->pubsync();
+}
+
+DigestTeeInputStreamBuf::DigestTeeInputStreamBuf(std::streambuf* source,
+                                                 Poco::DigestEngine* engine)
+    : m_source(source), m_engine(engine), m_read_started(false) {
+    setg(m_buffer, m_buffer, m_buffer);
+}
+
+DigestTeeInputStreamBuf::int_type DigestTeeInputStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    m_read_started = true;
+    std::streamsize n = m_source->sgetn(m_buffer, kBufferSize);
+    if (n <= 0) {
+        return traits_type::eof();
+    }
+    m_engine->update(m_buffer, static_cast<size_t>(n));
+    setg(m_buffer, m_buffer, m_buffer + n);
+    return traits_type::to_int_type(*gptr());
+}
+
+DigestTeeInputStreamBuf::pos_type DigestTeeInputStreamBuf::seekoff(
+        off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+    // tellg不移动读位置, 读取过程中也允许调用
+    if (off == 0 && dir == std::ios_base::cur) {
+        pos_type pos = m_source->pubseekoff(0, std::ios_base::cur, which);
+        if (pos == pos_type(off_type(-1))) {
+            return pos;
+        }
+        return pos - off_type(egptr() - gptr());
+    }
+
+    if (m_read_started) {
+        return pos_type(off_type(-1));
+    }
+    return m_source->pubseekoff(off, dir, which);
+}
+
+DigestTeeInputStreamBuf::pos_type DigestTeeInputStreamBuf::seekpos(
+        pos_type pos, std::ios_base::openmode which) {
+    if (m_read_started) {
+        return pos_type(off_type(-1));
+    }
+    return m_source->pubseekpos(pos, which);
+}
+
+Md5TeeInputStream::Md5TeeInputStream(std::istream& source)
+    : std::istream(NULL), m_buf(source.rdbuf(), &m_md5) {
+    init(&m_buf);
+}
+
+std::string Md5TeeInputStream::GetMd5() {
+    return Poco::DigestEngine::digestToHex(m_md5.digest());
+}
+
+Md5TeeOutputStream::Md5TeeOutputStream(std::ostream& sink)
+    : std::ostream(NULL), m_buf(sink.rdbuf(), &m_md5) {
+    init(&m_buf);
+}
+
+std::string Md5TeeOutputStream::GetMd5() {
+    return Poco::DigestEngine::digestToHex(m_md5.digest());
+}
+
+} // namespace qcloud_cos
@@ -0,0 +1,69 @@
+#include "util/socket_options.h"
+
+#include <errno.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "cos_defines.h"
+#include "cos_sys_config.h"
+
+namespace qcloud_cos {
+
+void SocketOptions::SetOption(int sockfd, int level, int option, int value, const char* name) {
+    if (setsockopt(sockfd, level, option, &value, sizeof(value)) != 0) {
+        SDK_LOG_WARN("Set socket option %s=%d fail, errno=%d, error=%s",
+                     name, value, errno, strerror(errno));
+    }
+}
+
+void SocketOptions::Apply(Poco::Net::StreamSocket& socket) {
+    Poco::Net::SocketImpl* impl = socket.impl();
+    if (impl == NULL || !impl->initialized()) {
+        return;
+    }
+    Apply(impl->sockfd());
+}
+
+void SocketOptions::Apply(int sockfd) {
+    if (CosSysConfig::IsTcpNoDelay()) {
+        SetOption(sockfd, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+    }
+
+    if (CosSysConfig::GetSocketSendBufferSize() > 0) {
+        SetOption(sockfd, SOL_SOCKET, SO_SNDBUF, CosSysConfig::GetSocketSendBufferSize(),
+                  "SO_SNDBUF");
+    }
+
+    if (CosSysConfig::GetSocketRecvBufferSize() > 0) {
+        SetOption(sockfd, SOL_SOCKET, SO_RCVBUF, CosSysConfig::GetSocketRecvBufferSize(),
+                  "SO_RCVBUF");
+    }
+
+    if (CosSysConfig::GetKeepAlive()) {
+        SetOption(sockfd, SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE");
+#ifdef TCP_KEEPIDLE
+        if (CosSysConfig::GetKeepIdle() > 0) {
+            SetOption(sockfd, IPPROTO_TCP, TCP_KEEPIDLE, (int)CosSysConfig::GetKeepIdle(),
+                      "TCP_KEEPIDLE");
+        }
+#endif
+#ifdef TCP_KEEPINTVL
+        if (CosSysConfig::GetKeepIntvl() > 0) {
+            SetOption(sockfd, IPPROTO_TCP, TCP_KEEPINTVL, (int)CosSysConfig::GetKeepIntvl(),
+                      "TCP_KEEPINTVL");
+        }
+#endif
+    }
+
+#ifdef TCP_NOTSENT_LOWAT
+    // 限制内核中未发送数据的大小, 避免大块数据长时间堆积在发送缓冲区
+    if (CosSysConfig::GetTcpNotSentLowat() > 0) {
+        SetOption(sockfd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, CosSysConfig::GetTcpNotSentLowat(),
+                  "TCP_NOTSENT_LOWAT");
+    }
+#endif
+}
+
+} // namespace qcloud_cos
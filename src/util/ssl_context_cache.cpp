@@ -0,0 +1,70 @@
+#include "util/ssl_context_cache.h"
+
+#include "cos_defines.h"
+#include "cos_sys_config.h"
+#include "util/string_util.h"
+
+namespace qcloud_cos {
+
+SimpleMutex SslContextCache::m_mutex;
+std::string SslContextCache::m_config_key = "";
+Poco::Net::Context::Ptr SslContextCache::m_context;
+
+std::string SslContextCache::GetConfigKey() {
+    return StringUtil::IntToString(CosSysConfig::GetSslVerifyMode()) + "|"
+        + CosSysConfig::GetSslCipherList() + "|" + CosSysConfig::GetSslCaLocation() + "|"
+        + (CosSysConfig::IsUseTlsSessionCache() ? "1" : "0");
+}
+
+Poco::Net::Context::Ptr SslContextCache::CreateClientContext() {
+    Poco::Net::Context::VerificationMode verify_mode = Poco::Net::Context::VERIFY_RELAXED;
+    switch (CosSysConfig::GetSslVerifyMode()) {
+    case COS_SSL_VERIFY_NONE:
+        verify_mode = Poco::Net::Context::VERIFY_NONE;
+        break;
+    case COS_SSL_VERIFY_STRICT:
+        verify_mode = Poco::Net::Context::VERIFY_STRICT;
+        break;
+    default:
+        break;
+    }
+
+    std::string cipher_list = CosSysConfig::GetSslCipherList();
+    if (cipher_list.empty()) {
+        cipher_list = "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH";
+    }
+
+    // 指定了CA路径时只信任该路径下的证书
+    std::string ca_location = CosSysConfig::GetSslCaLocation();
+    bool load_default_cas = ca_location.empty();
+
+    SDK_LOG_INFO("Create ssl client context, verify_mode=%d, cipher_list=%s, ca_location=%s",
+                 CosSysConfig::GetSslVerifyMode(), cipher_list.c_str(), ca_location.c_str());
+    Poco::Net::Context::Ptr context = new Poco::Net::Context(Poco::Net::Context::CLIENT_USE,
+                                                             "", "", ca_location, verify_mode,
+                                                             9, load_default_cas, cipher_list);
+    // 客户端需要开启会话缓存, 握手后才能拿到可复用的TLS会话
+    if (CosSysConfig::IsUseTlsSessionCache()) {
+        context->enableSessionCache(true);
+    }
+    return context;
+}
+
+Poco::Net::Context::Ptr SslContextCache::GetClientContext() {
+    std::string config_key = GetConfigKey();
+
+    SimpleMutexLocker locker(&m_mutex);
+    if (m_context.isNull() || config_key != m_config_key) {
+        m_context = CreateClientContext();
+        m_config_key = config_key;
+    }
+    return m_context;
+}
+
+void SslContextCache::Clear() {
+    SimpleMutexLocker locker(&m_mutex);
+    m_context = Poco::Net::Context::Ptr();
+    m_config_key.clear();
+}
+
+} // namespace qcloud_cos
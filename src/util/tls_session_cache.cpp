@@ -0,0 +1,241 @@
+#include "util/tls_session_cache.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <openssl/ssl.h>
+
+#include "cos_defines.h"
+#include "cos_sys_config.h"
+#include "util/codec_util.h"
+#include "util/string_util.h"
+
+namespace qcloud_cos {
+
+TlsSessionCache& TlsSessionCache::Instance() {
+    // 与连接池一样不在进程退出时析构, 避免与OpenSSL的全局对象析构顺序冲突
+    static TlsSessionCache* s_cache = new TlsSessionCache();
+    return *s_cache;
+}
+
+std::string TlsSessionCache::GetEndpointKey(const std::string& host, uint16_t port) {
+    return host + ":" + StringUtil::IntToString(port);
+}
+
+bool TlsSessionCache::IsExpired(SSL_SESSION* ssl_session) {
+    if (ssl_session == NULL) {
+        return true;
+    }
+
+    uint64_t expire_time = (uint64_t)SSL_SESSION_get_time(ssl_session)
+        + (uint64_t)SSL_SESSION_get_timeout(ssl_session);
+    return expire_time <= (uint64_t)time(NULL);
+}
+
+TlsSessionCache::SessionEntry* TlsSessionCache::FindEntry(const std::string& host,
+                                                          uint16_t port) {
+    if (!m_loaded) {
+        m_loaded = true;
+        std::string file_path = CosSysConfig::GetTlsSessionCacheFile();
+        if (!file_path.empty()) {
+            LoadFromFile(file_path);
+        }
+    }
+
+    std::map<std::string, SessionEntry>::iterator itr
+        = m_sessions.find(GetEndpointKey(host, port));
+    if (itr == m_sessions.end()) {
+        return NULL;
+    }
+
+    SessionEntry& entry = itr->second;
+    if (!entry.m_poco_session.isNull() && IsExpired(entry.m_poco_session->sslSession())) {
+        entry.m_poco_session = NULL;
+    }
+    if (IsExpired(entry.m_ssl_session.Get())) {
+        m_sessions.erase(itr);
+        return NULL;
+    }
+    return &entry;
+}
+
+SslSessionRef TlsSessionCache::Get(const std::string& host, uint16_t port) {
+    if (!CosSysConfig::IsUseTlsSessionCache()) {
+        return SslSessionRef();
+    }
+
+    SimpleMutexLocker locker(&m_mutex);
+    SessionEntry* entry = FindEntry(host, port);
+    if (entry == NULL) {
+        return SslSessionRef();
+    }
+    return entry->m_ssl_session;
+}
+
+Poco::Net::Session::Ptr TlsSessionCache::GetPocoSession(const std::string& host,
+                                                        uint16_t port) {
+    if (!CosSysConfig::IsUseTlsSessionCache()) {
+        return NULL;
+    }
+
+    SimpleMutexLocker locker(&m_mutex);
+    SessionEntry* entry = FindEntry(host, port);
+    if (entry == NULL) {
+        return NULL;
+    }
+    return entry->m_poco_session;
+}
+
+void TlsSessionCache::Put(const std::string& host, uint16_t port,
+                          const SslSessionRef& ssl_session) {
+    if (!CosSysConfig::IsUseTlsSessionCache() || ssl_session.IsNull()) {
+        return;
+    }
+
+    SimpleMutexLocker locker(&m_mutex);
+    PutEntry(host, port, ssl_session, NULL);
+}
+
+void TlsSessionCache::Put(const std::string& host, uint16_t port,
+                          Poco::Net::Session::Ptr poco_session) {
+    if (!CosSysConfig::IsUseTlsSessionCache() || poco_session.isNull()
+        || poco_session->sslSession() == NULL) {
+        return;
+    }
+
+    SimpleMutexLocker locker(&m_mutex);
+    PutEntry(host, port, SslSessionRef::Share(poco_session->sslSession()), poco_session);
+}
+
+void TlsSessionCache::PutEntry(const std::string& host, uint16_t port,
+                               const SslSessionRef& ssl_session,
+                               Poco::Net::Session::Ptr poco_session) {
+    std::string key = GetEndpointKey(host, port);
+    bool is_new_endpoint = (m_sessions.find(key) == m_sessions.end());
+    SessionEntry& entry = m_sessions[key];
+    entry.m_ssl_session = ssl_session;
+    // 异步引擎得到的会话不能交给Poco, 保留之前同步连接的Poco会话继续复用
+    if (!poco_session.isNull()) {
+        entry.m_poco_session = poco_session;
+    }
+
+    // 每个endpoint首次握手成功后立即落盘, 保证进程异常退出时下次启动也能复用
+    std::string file_path = CosSysConfig::GetTlsSessionCacheFile();
+    if (is_new_endpoint && !file_path.empty()) {
+        SaveToFile(file_path);
+    }
+}
+
+void TlsSessionCache::Save() {
+    std::string file_path = CosSysConfig::GetTlsSessionCacheFile();
+    if (file_path.empty()) {
+        return;
+    }
+
+    SimpleMutexLocker locker(&m_mutex);
+    SaveToFile(file_path);
+}
+
+void TlsSessionCache::Clear() {
+    Save();
+
+    SimpleMutexLocker locker(&m_mutex);
+    m_sessions.clear();
+    m_loaded = false;
+}
+
+void TlsSessionCache::LoadFromFile(const std::string& file_path) {
+    std::ifstream ifs(file_path.c_str());
+    if (!ifs) {
+        SDK_LOG_DBG("Tls session cache file not exist, file_path=%s", file_path.c_str());
+        return;
+    }
+
+    // 每行格式: host:port 会话的DER编码(十六进制)
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        std::string hex;
+        if (!(iss >> key >> hex)) {
+            continue;
+        }
+
+        std::string der = CodecUtil::HexToBin(hex);
+        if (der.empty()) {
+            continue;
+        }
+
+        const unsigned char* p = (const unsigned char*)der.data();
+        SSL_SESSION* ssl_session = d2i_SSL_SESSION(NULL, &p, (long)der.size());
+        if (ssl_session == NULL) {
+            SDK_LOG_WARN("Parse tls session fail, endpoint=%s", key.c_str());
+            continue;
+        }
+
+        if (IsExpired(ssl_session)) {
+            SSL_SESSION_free(ssl_session);
+            continue;
+        }
+
+        // 接管d2i_SSL_SESSION返回的引用
+        m_sessions[key].m_ssl_session = SslSessionRef(ssl_session);
+    }
+    SDK_LOG_INFO("Load tls session cache, file_path=%s, count=%lu",
+                 file_path.c_str(), m_sessions.size());
+}
+
+void TlsSessionCache::SaveToFile(const std::string& file_path) {
+    std::string content;
+    for (std::map<std::string, SessionEntry>::const_iterator itr
+            = m_sessions.begin(); itr != m_sessions.end(); ++itr) {
+        SSL_SESSION* ssl_session = itr->second.m_ssl_session.Get();
+        if (IsExpired(ssl_session)) {
+            continue;
+        }
+
+        int der_len = i2d_SSL_SESSION(ssl_session, NULL);
+        if (der_len <= 0) {
+            continue;
+        }
+
+        std::vector<unsigned char> der(der_len);
+        unsigned char* p = &der[0];
+        i2d_SSL_SESSION(ssl_session, &p);
+
+        std::vector<char> hex(der_len * 2);
+        CodecUtil::BinToHex(&der[0], der_len, &hex[0]);
+        content += itr->first + " " + std::string(&hex[0], hex.size()) + "\n";
+    }
+
+    // 会话中包含会话密钥, 文件仅对当前用户可读写; 先写临时文件再rename, 避免写入不完整
+    std::string tmp_path = file_path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        SDK_LOG_WARN("Open tls session cache file fail, file_path=%s", tmp_path.c_str());
+        return;
+    }
+
+    size_t offset = 0;
+    while (offset < content.size()) {
+        ssize_t ret = write(fd, content.data() + offset, content.size() - offset);
+        if (ret <= 0) {
+            break;
+        }
+        offset += ret;
+    }
+    close(fd);
+
+    if (offset != content.size() || rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+        SDK_LOG_WARN("Save tls session cache fail, file_path=%s", file_path.c_str());
+        unlink(tmp_path.c_str());
+    }
+}
+
+} // namespace qcloud_cos
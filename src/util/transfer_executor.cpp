@@ -0,0 +1,213 @@
+#include "util/transfer_executor.h"
+
+#include <exception>
+
+#include <boost/bind.hpp>
+
+#include "cos_defines.h"
+#include "cos_sys_config.h"
+
+namespace qcloud_cos {
+
+namespace {
+
+// 当前线程所属的工作线程下标, 非工作线程为-1
+__thread int s_worker_index = -1;
+
+void RunTaskSafely(const TransferExecutor::Task& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        SDK_LOG_ERR("Transfer task throw exception: %s", e.what());
+    }
+}
+
+} // namespace
+
+TransferExecutor& TransferExecutor::Instance() {
+    // 与HttpSessionPool相同, 不在进程退出时析构, 工作线程由CosAPI在最后一个实例析构时Stop
+    static TransferExecutor* s_executor = new TransferExecutor();
+    return *s_executor;
+}
+
+void TransferExecutor::Start(unsigned thread_num) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    StartLocked(thread_num);
+}
+
+void TransferExecutor::StartLocked(unsigned thread_num) {
+    if (m_running) {
+        return;
+    }
+
+    // 传输任务大部分时间在等待网络, 每个核对应多个工作线程
+    if (thread_num == 0) {
+        thread_num = boost::thread::hardware_concurrency() * kTransferThreadNumPerCpu;
+        if (thread_num == 0) {
+            thread_num = kDefaultThreadPoolSizeUploadPart;
+        }
+    }
+
+    for (unsigned i = 0; i < thread_num; ++i) {
+        m_workers.push_back(new Worker());
+    }
+    for (unsigned i = 0; i < thread_num; ++i) {
+        m_threads.push_back(new boost::thread(boost::bind(&TransferExecutor::WorkerLoop, this, i)));
+    }
+    m_running = true;
+    SDK_LOG_INFO("Transfer executor start, thread_num=%u", thread_num);
+}
+
+void TransferExecutor::Stop() {
+    std::vector<boost::thread*> threads;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+        m_stopping = true;
+        threads.swap(m_threads);
+    }
+    m_task_cond.notify_all();
+
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+        delete threads[i];
+    }
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        for (size_t i = 0; i < m_workers.size(); ++i) {
+            delete m_workers[i];
+        }
+        m_workers.clear();
+        m_next_worker = 0;
+        m_stopping = false;
+    }
+    m_stop_cond.notify_all();
+}
+
+void TransferExecutor::Schedule(const Task& task) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    unsigned max_inflight = CosSysConfig::GetMaxInflightTransferTasks();
+    while (true) {
+        // Stop会在回收线程后删除m_workers, 非工作线程必须等它结束.
+        // 工作线程提交的任务由仍在运行的工作线程执行完, 不能等待, 否则Stop无法join
+        if (m_stopping && s_worker_index < 0) {
+            m_stop_cond.wait(lock);
+            continue;
+        }
+        if (!m_running && !m_stopping) {
+            StartLocked(CosSysConfig::GetTransferThreadPoolSize());
+        }
+        // 工作线程等待额度会占住线程, 所有线程都在等待时没有任务能完成, 因此不受上限限制
+        if (max_inflight > 0 && m_inflight_num >= max_inflight && s_worker_index < 0) {
+            m_slot_cond.wait(lock);
+            continue;
+        }
+        break;
+    }
+    ++m_inflight_num;
+
+    // 工作线程提交的任务放入自己的队列, 其他线程提交的任务轮流放入各个队列.
+    // 持有m_mutex放入队列, 保证期间m_workers不会被Stop删除
+    unsigned index = 0;
+    if (s_worker_index >= 0 && static_cast<size_t>(s_worker_index) < m_workers.size()) {
+        index = s_worker_index;
+    } else {
+        index = m_next_worker++ % m_workers.size();
+    }
+    {
+        Worker* worker = m_workers[index];
+        boost::mutex::scoped_lock worker_lock(worker->m_mutex);
+        worker->m_tasks.push_back(task);
+    }
+    ++m_pending_num;
+    lock.unlock();
+    m_task_cond.notify_one();
+}
+
+unsigned TransferExecutor::GetThreadNum() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_running ? m_threads.size() : 0;
+}
+
+bool TransferExecutor::PopTask(unsigned index, Task* task) {
+    {
+        Worker* worker = m_workers[index];
+        boost::mutex::scoped_lock lock(worker->m_mutex);
+        if (!worker->m_tasks.empty()) {
+            *task = worker->m_tasks.front();
+            worker->m_tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < m_workers.size(); ++i) {
+        Worker* victim = m_workers[(index + i) % m_workers.size()];
+        boost::mutex::scoped_lock lock(victim->m_mutex);
+        if (!victim->m_tasks.empty()) {
+            *task = victim->m_tasks.back();
+            victim->m_tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TransferExecutor::WorkerLoop(unsigned index) {
+    s_worker_index = index;
+    while (true) {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            while (m_pending_num == 0 && m_running) {
+                m_task_cond.wait(lock);
+            }
+            // 停止时先执行完队列中剩余的任务
+            if (m_pending_num == 0) {
+                break;
+            }
+            // 先领取一个任务的额度, 保证下面一定能从某个队列中取到任务
+            --m_pending_num;
+        }
+
+        Task task;
+        while (!PopTask(index, &task)) {
+            boost::this_thread::yield();
+        }
+        RunTaskSafely(task);
+
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            --m_inflight_num;
+        }
+        m_slot_cond.notify_one();
+    }
+    s_worker_index = -1;
+}
+
+void TransferTaskGroup::Schedule(const TransferExecutor::Task& task) {
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        ++m_running_num;
+    }
+    TransferExecutor::Instance().Schedule(boost::bind(&TransferTaskGroup::RunTask, this, task));
+}
+
+void TransferTaskGroup::Wait() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_running_num > 0) {
+        m_cond.wait(lock);
+    }
+}
+
+void TransferTaskGroup::RunTask(const TransferExecutor::Task& task) {
+    RunTaskSafely(task);
+    // 持锁通知, Wait返回后本组对象可能立即析构
+    boost::mutex::scoped_lock lock(m_mutex);
+    --m_running_num;
+    m_cond.notify_all();
+}
+
+} // namespace qcloud_cos
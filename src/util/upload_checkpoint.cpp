@@ -0,0 +1,100 @@
+#include "util/upload_checkpoint.h"
+
+#include <unistd.h>
+
+#include <fstream>
+
+#include "json/json.h"
+
+#include "cos_sys_config.h"
+#include "util/file_util.h"
+#include "util/string_util.h"
+
+namespace qcloud_cos {
+
+bool UploadCheckpoint::Load(const std::string& checkpoint_file) {
+    std::ifstream is(checkpoint_file.c_str(), std::ios::in);
+    if (!is || !is.is_open()) {
+        return false;
+    }
+
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(is, root, false) || !root.isObject()) {
+        SDK_LOG_WARN("Parse upload checkpoint fail, checkpoint_file=%s",
+                     checkpoint_file.c_str());
+        return false;
+    }
+
+    m_upload_id = root["UploadId"].asString();
+    m_bucket_name = root["Bucket"].asString();
+    m_object_name = root["Key"].asString();
+    m_part_size = root["PartSize"].asUInt64();
+    m_file_size = root["FileSize"].asUInt64();
+    m_file_mtime = root["FileMtime"].asUInt64();
+    m_file_md5 = root["FileMd5"].asString();
+
+    // 没有CRC64的分块(旧版本写入的checkpoint)无法参与整个对象的CRC64校验, 当作未上传
+    m_parts.clear();
+    m_part_crc64s.clear();
+    const Json::Value& parts = root["Parts"];
+    for (Json::Value::ArrayIndex i = 0; i < parts.size(); ++i) {
+        const std::string& crc64 = parts[i]["Crc64"].asString();
+        if (crc64.empty()) {
+            continue;
+        }
+        uint64_t part_number = parts[i]["PartNumber"].asUInt64();
+        m_parts[part_number] = parts[i]["ETag"].asString();
+        m_part_crc64s[part_number] = StringUtil::StringToUint64(crc64);
+    }
+    return true;
+}
+
+bool UploadCheckpoint::Save(const std::string& checkpoint_file) const {
+    Json::Value root;
+    root["UploadId"] = m_upload_id;
+    root["Bucket"] = m_bucket_name;
+    root["Key"] = m_object_name;
+    root["PartSize"] = Json::UInt64(m_part_size);
+    root["FileSize"] = Json::UInt64(m_file_size);
+    root["FileMtime"] = Json::UInt64(m_file_mtime);
+    root["FileMd5"] = m_file_md5;
+
+    Json::Value parts(Json::arrayValue);
+    for (std::map<uint64_t, std::string>::const_iterator itr = m_parts.begin();
+         itr != m_parts.end(); ++itr) {
+        Json::Value part;
+        part["PartNumber"] = Json::UInt64(itr->first);
+        part["ETag"] = itr->second;
+        // CRC64以十进制字符串保存, 与x-cos-hash-crc64ecma的格式一致
+        std::map<uint64_t, uint64_t>::const_iterator crc_itr = m_part_crc64s.find(itr->first);
+        if (crc_itr != m_part_crc64s.end()) {
+            part["Crc64"] = StringUtil::Uint64ToString(crc_itr->second);
+        }
+        parts.append(part);
+    }
+    root["Parts"] = parts;
+
+    Json::FastWriter writer;
+    if (!FileUtil::AtomicWriteFile(checkpoint_file, writer.write(root))) {
+        SDK_LOG_WARN("Save upload checkpoint fail, checkpoint_file=%s",
+                     checkpoint_file.c_str());
+        return false;
+    }
+    return true;
+}
+
+void UploadCheckpoint::Remove(const std::string& checkpoint_file) {
+    unlink(checkpoint_file.c_str());
+}
+
+bool UploadCheckpoint::IsSameUpload(const UploadCheckpoint& other) const {
+    return m_bucket_name == other.m_bucket_name
+        && m_object_name == other.m_object_name
+        && m_part_size == other.m_part_size
+        && m_file_size == other.m_file_size
+        && m_file_mtime == other.m_file_mtime
+        && m_file_md5 == other.m_file_md5;
+}
+
+} // namespace qcloud_cos
@@ -0,0 +1,193 @@
+#include "util/url_encode.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define COS_URL_ENCODE_USE_SIMD 1
+#endif
+
+#include "util/codec_util.h"
+
+namespace qcloud_cos {
+
+namespace {
+
+// 不需要编码的字符: 字母、数字以及-_.~, EncodeKey额外保留'/'
+inline bool IsUnreserved(unsigned char c, bool keep_slash) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+        || c == '-' || c == '_' || c == '.' || c == '~' || (keep_slash && c == '/');
+}
+
+size_t UnreservedPrefixLenScalar(const char* p, size_t len, bool keep_slash) {
+    size_t i = 0;
+    while (i < len && IsUnreserved((unsigned char)p[i], keep_slash)) {
+        ++i;
+    }
+    return i;
+}
+
+size_t CountReservedScalar(const char* p, size_t len, bool keep_slash) {
+    size_t num = 0;
+    for (size_t i = 0; i < len; ++i) {
+        num += IsUnreserved((unsigned char)p[i], keep_slash) ? 0 : 1;
+    }
+    return num;
+}
+
+#ifdef COS_URL_ENCODE_USE_SIMD
+// 按有符号比较, 大于0x7f的字节为负数, 不会落入任何区间
+__attribute__((target("sse2")))
+inline unsigned UnreservedMask16(const char* p, bool keep_slash) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                               _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    ok = _mm_or_si128(ok, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1))));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('.')));
+    ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('~')));
+    if (keep_slash) {
+        ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+    }
+    return static_cast<unsigned>(_mm_movemask_epi8(ok));
+}
+
+__attribute__((target("avx2")))
+inline unsigned UnreservedMask32(const char* p, bool keep_slash) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i ok = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                  _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    ok = _mm256_or_si256(ok, _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                              _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v)));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')));
+    ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('~')));
+    if (keep_slash) {
+        ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+    }
+    return static_cast<unsigned>(_mm256_movemask_epi8(ok));
+}
+
+__attribute__((target("sse2")))
+size_t UnreservedPrefixLenSse2(const char* p, size_t len, bool keep_slash) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        unsigned mask = UnreservedMask16(p + i, keep_slash);
+        if (mask != 0xffff) {
+            return i + __builtin_ctz(~mask);
+        }
+    }
+    return i + UnreservedPrefixLenScalar(p + i, len - i, keep_slash);
+}
+
+__attribute__((target("sse2")))
+size_t CountReservedSse2(const char* p, size_t len, bool keep_slash) {
+    size_t num = 0;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        num += __builtin_popcount(~UnreservedMask16(p + i, keep_slash) & 0xffff);
+    }
+    return num + CountReservedScalar(p + i, len - i, keep_slash);
+}
+
+// 尾部不足32字节时在本函数内按16字节处理, 不调用非VEX编码的SSE2函数, 避免AVX/SSE切换开销
+__attribute__((target("avx2")))
+size_t UnreservedPrefixLenAvx2(const char* p, size_t len, bool keep_slash) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        unsigned mask = UnreservedMask32(p + i, keep_slash);
+        if (mask != 0xffffffffu) {
+            return i + __builtin_ctz(~mask);
+        }
+    }
+    if (i + 16 <= len) {
+        unsigned mask = UnreservedMask16(p + i, keep_slash);
+        if (mask != 0xffff) {
+            return i + __builtin_ctz(~mask);
+        }
+        i += 16;
+    }
+    _mm256_zeroupper();
+    return i + UnreservedPrefixLenScalar(p + i, len - i, keep_slash);
+}
+
+__attribute__((target("avx2")))
+size_t CountReservedAvx2(const char* p, size_t len, bool keep_slash) {
+    size_t num = 0;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        num += __builtin_popcount(~UnreservedMask32(p + i, keep_slash));
+    }
+    if (i + 16 <= len) {
+        num += __builtin_popcount(~UnreservedMask16(p + i, keep_slash) & 0xffff);
+        i += 16;
+    }
+    _mm256_zeroupper();
+    return num + CountReservedScalar(p + i, len - i, keep_slash);
+}
+
+bool IsAvx2Supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+// 从p开始连续的不需要编码的字符个数
+size_t UnreservedPrefixLen(const char* p, size_t len, bool keep_slash) {
+#ifdef COS_URL_ENCODE_USE_SIMD
+    static const bool is_avx2_supported = IsAvx2Supported();
+    return is_avx2_supported ? UnreservedPrefixLenAvx2(p, len, keep_slash)
+                             : UnreservedPrefixLenSse2(p, len, keep_slash);
+#else
+    return UnreservedPrefixLenScalar(p, len, keep_slash);
+#endif
+}
+
+// 需要编码的字符个数
+size_t CountReserved(const char* p, size_t len, bool keep_slash) {
+#ifdef COS_URL_ENCODE_USE_SIMD
+    static const bool is_avx2_supported = IsAvx2Supported();
+    return is_avx2_supported ? CountReservedAvx2(p, len, keep_slash)
+                             : CountReservedSse2(p, len, keep_slash);
+#else
+    return CountReservedScalar(p, len, keep_slash);
+#endif
+}
+
+} // namespace
+
+// 先统计需要编码的字符数, 一次性扩展out到最终大小, 再把连续的不需要编码的字符整段拷贝
+void UrlEncodeAppend(const std::string& str, bool keep_slash, std::string* out) {
+    const char* p = str.data();
+    size_t len = str.size();
+    size_t reserved_num = CountReserved(p, len, keep_slash);
+    if (reserved_num == 0) {
+        out->append(str);
+        return;
+    }
+
+    size_t old_size = out->size();
+    out->resize(old_size + len + 2 * reserved_num);
+    char* dst = &(*out)[old_size];
+    size_t i = 0;
+    while (i < len) {
+        size_t run = UnreservedPrefixLen(p + i, len - i, keep_slash);
+        memcpy(dst, p + i, run);
+        dst += run;
+        i += run;
+        if (i < len) {
+            unsigned char c = p[i];
+            *dst++ = '%';
+            *dst++ = CodecUtil::ToHex(c >> 4);
+            *dst++ = CodecUtil::ToHex(c & 15);
+            ++i;
+        }
+    }
+}
+
+} // namespace qcloud_cos
@@ -0,0 +1,200 @@
+// Description: AuthTool::Sign的微基准, 与改造前逐步拼接字符串的实现对比,
+//              同时校验两者的签名结果一致. 用法: auth_tool_bench [iterations]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+#include "util/auth_tool.h"
+#include "util/codec_util.h"
+#include "util/string_util.h"
+
+namespace {
+
+using qcloud_cos::CodecUtil;
+using qcloud_cos::StringUtil;
+
+typedef std::map<std::string, std::string> StringMap;
+
+// 小写的16进制
+std::string ToHex(const unsigned char* data, unsigned int len) {
+    std::string hex;
+    for (unsigned int i = 0; i < len; ++i) {
+        char buf[3];
+        snprintf(buf, sizeof(buf), "%02x", data[i]);
+        hex.append(buf, 2);
+    }
+    return hex;
+}
+
+// 改造前的实现: 每次计算都新建HMAC_CTX, 不经过CodecUtil中缓存的线程局部上下文
+std::string LegacyHmacSha1Hex(const std::string& plain_text, const std::string& key) {
+    unsigned char output[EVP_MAX_MD_SIZE];
+    unsigned int output_len = 0;
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    HMAC_CTX ctx;
+    HMAC_CTX_init(&ctx);
+    HMAC_Init_ex(&ctx, key.data(), key.length(), EVP_sha1(), NULL);
+    HMAC_Update(&ctx, (const unsigned char*)plain_text.data(), plain_text.length());
+    HMAC_Final(&ctx, output, &output_len);
+    HMAC_CTX_cleanup(&ctx);
+#else
+    HMAC_CTX* ctx = HMAC_CTX_new();
+    HMAC_Init_ex(ctx, key.data(), key.length(), EVP_sha1(), NULL);
+    HMAC_Update(ctx, (const unsigned char*)plain_text.data(), plain_text.length());
+    HMAC_Final(ctx, output, &output_len);
+    HMAC_CTX_free(ctx);
+#endif
+    return ToHex(output, output_len);
+}
+
+// 改造前的实现, 不使用Sha1, 避免对比时两边共用同一份优化
+std::string LegacySha1Hex(const std::string& data) {
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1((const unsigned char*)data.data(), data.size(), digest);
+    return ToHex(digest, SHA_DIGEST_LENGTH);
+}
+
+// 改造前的实现
+void LegacyFillMap(const StringMap& params, bool key_encode, bool value_encode,
+                   std::string* param_list, std::string* param_value_list) {
+    if (params.empty()) {
+        return;
+    }
+
+    StringMap trim_params;
+    for (StringMap::const_iterator itr = params.begin(); itr != params.end(); ++itr) {
+        std::string key = itr->first;
+        std::string value = value_encode ? CodecUtil::UrlEncode(itr->second) : itr->second;
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        trim_params[key] = value;
+    }
+
+    for (StringMap::const_iterator itr = trim_params.begin(); itr != trim_params.end(); ++itr) {
+        std::string key = key_encode ? CodecUtil::UrlEncode(itr->first) : itr->first;
+        if (itr != trim_params.begin()) {
+            *param_list += ";";
+            *param_value_list += "&";
+        }
+        *param_list += key;
+        *param_value_list += key + "=" + itr->second;
+    }
+}
+
+std::string LegacySign(const std::string& access_key, const std::string& secret_key,
+                       const std::string& http_method, const std::string& uri,
+                       const StringMap& headers, const StringMap& params,
+                       uint64_t start_time_in_s, uint64_t end_time_in_s) {
+    std::string start_end_time_str = StringUtil::Uint64ToString(start_time_in_s) + ";"
+        + StringUtil::Uint64ToString(end_time_in_s);
+
+    StringMap filted_req_headers;
+    for (StringMap::const_iterator itr = headers.begin(); itr != headers.end(); ++itr) {
+        if ((itr->first[0] == 'x' || itr->first[0] == 'X')
+            || !strcasecmp(itr->first.c_str(), "content-type")
+            || !strcasecmp(itr->first.c_str(), "host")) {
+            filted_req_headers.insert(std::make_pair(itr->first, itr->second));
+        }
+    }
+
+    std::string header_list, header_value_list;
+    std::string param_list, param_value_list;
+    LegacyFillMap(params, true, true, &param_list, &param_value_list);
+    LegacyFillMap(filted_req_headers, false, true, &header_list, &header_value_list);
+
+    std::string format_str = StringUtil::StringToLower(http_method) + "\n" + uri + "\n"
+        + param_value_list + "\n" + header_value_list + "\n";
+
+    std::string string_to_sign = "sha1\n" + start_end_time_str + "\n"
+        + LegacySha1Hex(format_str) + "\n";
+
+    std::string sign_key = LegacyHmacSha1Hex(start_end_time_str, secret_key);
+    std::transform(sign_key.begin(), sign_key.end(), sign_key.begin(), ::tolower);
+    std::string signature = LegacyHmacSha1Hex(string_to_sign, sign_key);
+    std::transform(signature.begin(), signature.end(), signature.begin(), ::tolower);
+
+    return "q-sign-algorithm=sha1&q-ak=" + access_key +
+           "&q-sign-time=" + start_end_time_str +
+           "&q-key-time=" + start_end_time_str +
+           "&q-header-list=" + header_list +
+           "&q-url-param-list=" + param_list +
+           "&q-signature=" + signature;
+}
+
+uint64_t NowInUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+
+    const std::string access_key = "AKIDexampleexampleexampleexample";
+    const std::string secret_key = "secretkeyexampleexampleexample12";
+    const std::string uri = "/dir/object name with spaces.txt";
+
+    // 典型的PUT请求
+    StringMap headers;
+    headers["Host"] = "examplebucket-1250000000.cos.ap-guangzhou.myqcloud.com";
+    headers["Content-Type"] = "application/octet-stream";
+    headers["Content-Length"] = "1048576";
+    headers["Content-MD5"] = "ODhhYjM1ZmQ4NmE2NzRiOA==";
+    headers["x-cos-meta-author"] = "example user";
+    headers["x-cos-storage-class"] = "STANDARD";
+    headers["User-Agent"] = "cos-cpp-sdk-v5";
+    StringMap params;
+    params["partNumber"] = "12";
+    params["uploadId"] = "1585130821cbb7df1d11846c073ad648e8f33b087cec2381df437acdc833cf654b9ecc6361";
+
+    // 校验两种实现的结果一致, 包括大小写不同的重复key和需要编码的字符
+    StringMap odd_params = params;
+    odd_params["PartNumber"] = "13";
+    odd_params["a b"] = "c&d=e";
+    const StringMap* cases[][2] = {{&headers, &params}, {&headers, &odd_params}};
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        std::string expected = LegacySign(access_key, secret_key, "PUT", uri,
+                                          *cases[i][0], *cases[i][1], 1502493430, 1502573430);
+        std::string actual = qcloud_cos::AuthTool::Sign(access_key, secret_key, "PUT", uri,
+                                                        *cases[i][0], *cases[i][1],
+                                                        1502493430, 1502573430);
+        if (expected != actual) {
+            fprintf(stderr, "sign mismatch:\n  legacy: %s\n  actual: %s\n",
+                    expected.c_str(), actual.c_str());
+            return 1;
+        }
+    }
+
+    size_t total_len = 0;
+    uint64_t begin = NowInUs();
+    for (int i = 0; i < iterations; ++i) {
+        total_len += LegacySign(access_key, secret_key, "PUT", uri, headers, params,
+                                1502493430, 1502573430).size();
+    }
+    uint64_t legacy_us = NowInUs() - begin;
+
+    begin = NowInUs();
+    for (int i = 0; i < iterations; ++i) {
+        total_len += qcloud_cos::AuthTool::Sign(access_key, secret_key, "PUT", uri,
+                                                headers, params, 1502493430, 1502573430).size();
+    }
+    uint64_t sign_us = NowInUs() - begin;
+
+    printf("iterations: %d (checksum %lu)\n", iterations, total_len);
+    printf("legacy sign: %.0f ns/op\n", legacy_us * 1000.0 / iterations);
+    printf("sign:        %.0f ns/op\n", sign_us * 1000.0 / iterations);
+    printf("speedup:     %.2fx\n", sign_us > 0 ? static_cast<double>(legacy_us) / sign_us : 0.0);
+    return 0;
+}
@@ -8,6 +8,7 @@
 #include "gtest/gtest.h"
 
 #include "util/auth_tool.h"
+#include <cstdio>
 #include <iostream>
 
 namespace qcloud_cos {
@@ -85,4 +86,82 @@ TEST(AuthToolTest, NormalTest) {
     EXPECT_EQ("", sign_result);
 }
 
+namespace {
+
+std::string GetSignField(const std::string& sign, const std::string& field) {
+    size_t begin = sign.find(field + "=");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    begin += field.size() + 1;
+    return sign.substr(begin, sign.find('&', begin) - begin);
+}
+
+} // namespace
+
+TEST(AuthToolTest, KeyTimeWindowTest) {
+    std::map<std::string, std::string> headers;
+    headers["host"] = "hostname_test";
+    std::map<std::string, std::string> params;
+
+    // 1502493420是60的整数倍, 即一个q-key-time窗口的起点
+    const uint64_t window_start = 1502493420;
+    const uint64_t expired = 60;
+    std::string first = AuthTool::SignInKeyWindow("access_key_test", "secret_key_test", "PUT",
+                                                  "/first", headers, params,
+                                                  window_start + 5, expired);
+    EXPECT_EQ("1502493425;1502493485", GetSignField(first, "q-sign-time"));
+    EXPECT_EQ("1502493420;1502493540", GetSignField(first, "q-key-time"));
+
+    // 同一窗口内的请求使用相同的q-key-time
+    std::string second = AuthTool::SignInKeyWindow("access_key_test", "secret_key_test", "HEAD",
+                                                   "/second", headers, params,
+                                                   window_start + 50, expired);
+    EXPECT_EQ("1502493470;1502493530", GetSignField(second, "q-sign-time"));
+    EXPECT_EQ("1502493420;1502493540", GetSignField(second, "q-key-time"));
+    EXPECT_NE(GetSignField(first, "q-signature"), GetSignField(second, "q-signature"));
+
+    // 命中缓存的SignKey与第一次计算的结果一致
+    EXPECT_EQ(first, AuthTool::SignInKeyWindow("access_key_test", "secret_key_test", "PUT",
+                                               "/first", headers, params,
+                                               window_start + 5, expired));
+
+    // 同一窗口内不同的secret_key各自缓存, 互不覆盖
+    std::string other = AuthTool::SignInKeyWindow("access_key_test", "secret_key_other", "PUT",
+                                                  "/first", headers, params,
+                                                  window_start + 5, expired);
+    EXPECT_NE(GetSignField(first, "q-signature"), GetSignField(other, "q-signature"));
+    EXPECT_EQ(first, AuthTool::SignInKeyWindow("access_key_test", "secret_key_test", "PUT",
+                                               "/first", headers, params,
+                                               window_start + 5, expired));
+
+    // 进入下一个窗口后q-key-time对齐到新的起点
+    std::string next = AuthTool::SignInKeyWindow("access_key_test", "secret_key_test", "PUT",
+                                                 "/first", headers, params,
+                                                 window_start + expired + 5, expired);
+    EXPECT_EQ("1502493485;1502493545", GetSignField(next, "q-sign-time"));
+    EXPECT_EQ("1502493480;1502493600", GetSignField(next, "q-key-time"));
+    EXPECT_NE(GetSignField(first, "q-signature"), GetSignField(next, "q-signature"));
+
+    // 缓存已被新窗口替换, 或因secret_key过多被清空后, 重新计算的结果不变
+    EXPECT_EQ(first, AuthTool::SignInKeyWindow("access_key_test", "secret_key_test", "PUT",
+                                               "/first", headers, params,
+                                               window_start + 5, expired));
+    for (int i = 0; i < 100; ++i) {
+        char secret_key[32];
+        snprintf(secret_key, sizeof(secret_key), "secret_key_%d", i);
+        AuthTool::SignInKeyWindow("access_key_test", secret_key, "PUT", "/first",
+                                  headers, params, window_start + 5, expired);
+    }
+    EXPECT_EQ(first, AuthTool::SignInKeyWindow("access_key_test", "secret_key_test", "PUT",
+                                               "/first", headers, params,
+                                               window_start + 5, expired));
+
+    // 有效期为0时q-key-time与q-sign-time相同, 与指定起止时间的签名一致
+    EXPECT_EQ(AuthTool::Sign("access_key_test", "secret_key_test", "PUT", "/first",
+                             headers, params, window_start + 5, window_start + 5),
+              AuthTool::SignInKeyWindow("access_key_test", "secret_key_test", "PUT",
+                                        "/first", headers, params, window_start + 5, 0));
+}
+
 } // namespace qcloud_cos
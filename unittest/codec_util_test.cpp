@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "util/codec_util.h"
+
+namespace qcloud_cos {
+
+namespace {
+
+// 逐字符编码的参考实现
+std::string ReferenceEncode(const std::string& str, bool keep_slash) {
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string encoded;
+    for (size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = str[i];
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~'
+            || (keep_slash && c == '/')) {
+            encoded += c;
+        } else {
+            encoded += '%';
+            encoded += kHex[c >> 4];
+            encoded += kHex[c & 15];
+        }
+    }
+    return encoded;
+}
+
+// RFC 2202中HMAC-SHA1的测试用例
+struct HmacSha1Vector {
+    std::string key;
+    std::string data;
+    const char* hex;
+};
+
+std::vector<HmacSha1Vector> GetHmacSha1Vectors() {
+    std::string key_0x01_0x19;
+    for (char c = 0x01; c <= 0x19; ++c) {
+        key_0x01_0x19 += c;
+    }
+
+    // 最后两个用例的key为80字节, 超过SHA-1的64字节分组, 需要先对key做一次哈希
+    HmacSha1Vector vectors[] = {
+        {std::string(20, '\x0b'), "Hi There",
+         "b617318655057264e28bc0b6fb378c8ef146be00"},
+        {"Jefe", "what do ya want for nothing?",
+         "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"},
+        {std::string(20, '\xaa'), std::string(50, '\xdd'),
+         "125d7342b9ac11cd91a39af48aa17b4f63f175d3"},
+        {key_0x01_0x19, std::string(50, '\xcd'),
+         "4c9007f4026250c6bc8414f9bf50c86c2d7235da"},
+        {std::string(20, '\x0c'), "Test With Truncation",
+         "4c1a03424b55e07fe7f27be1d58bb9324a9a5a04"},
+        {std::string(80, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First",
+         "aa4ae5e15272d00e95705637ce8a3b55ed402112"},
+        {std::string(80, '\xaa'),
+         "Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data",
+         "e8e99d0f45237d786d6bbaa7965c7808bbff1a91"},
+    };
+    return std::vector<HmacSha1Vector>(vectors, vectors + sizeof(vectors) / sizeof(vectors[0]));
+}
+
+std::string ToLowerHex(const unsigned char* digest, size_t len) {
+    static const char kHex[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t i = 0; i < len; ++i) {
+        hex += kHex[digest[i] >> 4];
+        hex += kHex[digest[i] & 15];
+    }
+    return hex;
+}
+
+std::string ToLower(std::string str) {
+    for (size_t i = 0; i < str.size(); ++i) {
+        str[i] = tolower(static_cast<unsigned char>(str[i]));
+    }
+    return str;
+}
+
+} // namespace
+
+TEST(CodecUtilTest, UrlEncodeTest) {
+    EXPECT_EQ("", CodecUtil::UrlEncode(""));
+    EXPECT_EQ("abcXYZ019-_.~", CodecUtil::UrlEncode("abcXYZ019-_.~"));
+    EXPECT_EQ("a%20b%2Fc%3D%26%E4%B8%AD", CodecUtil::UrlEncode("a b/c=&\xe4\xb8\xad"));
+    EXPECT_EQ("dir/sub%20dir/%40%5B%60%7B.txt", CodecUtil::EncodeKey("dir/sub dir/@[`{.txt"));
+
+    std::string out = "prefix=";
+    CodecUtil::UrlEncode("a b", &out);
+    EXPECT_EQ("prefix=a%20b", out);
+}
+
+// 覆盖向量化路径的各种长度、分块边界以及所有字节值
+TEST(CodecUtilTest, UrlEncodeMatchReferenceTest) {
+    srand(20181016);
+    for (size_t len = 0; len < 300; ++len) {
+        for (int round = 0; round < 4; ++round) {
+            std::string str(len, 'a');
+            for (size_t i = 0; i < len; ++i) {
+                // 大部分为不需要编码的字符, 使连续段跨越16/32字节边界
+                str[i] = (rand() % 8 == 0) ? static_cast<char>(rand() % 256)
+                                           : "abcXYZ09-_.~/"[rand() % 13];
+            }
+            EXPECT_EQ(ReferenceEncode(str, false), CodecUtil::UrlEncode(str));
+            EXPECT_EQ(ReferenceEncode(str, true), CodecUtil::EncodeKey(str));
+        }
+    }
+
+    std::string all_bytes;
+    for (int c = 0; c < 256; ++c) {
+        all_bytes += static_cast<char>(c);
+    }
+    EXPECT_EQ(ReferenceEncode(all_bytes, false), CodecUtil::UrlEncode(all_bytes));
+    EXPECT_EQ(ReferenceEncode(all_bytes, true), CodecUtil::EncodeKey(all_bytes));
+}
+
+TEST(CodecUtilTest, HmacSha1Rfc2202Test) {
+    std::vector<HmacSha1Vector> vectors = GetHmacSha1Vectors();
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        const HmacSha1Vector& v = vectors[i];
+        EXPECT_EQ(v.hex, ToLower(CodecUtil::HmacSha1Hex(v.data, v.key))) << "case " << i + 1;
+
+        char hex[40];
+        CodecUtil::HmacSha1Hex(v.data.data(), v.data.size(), v.key.data(), v.key.size(), hex);
+        EXPECT_EQ(v.hex, ToLower(std::string(hex, sizeof(hex)))) << "case " << i + 1;
+    }
+}
+
+// 同一个HmacSha1Context在不同key之间来回切换, 以及同一key连续使用时复用已计算的状态
+TEST(CodecUtilTest, HmacSha1ContextSwitchKeyTest) {
+    std::vector<HmacSha1Vector> vectors = GetHmacSha1Vectors();
+    HmacSha1Context context;
+    unsigned char digest[20];
+    for (int round = 0; round < 3; ++round) {
+        for (size_t i = 0; i < vectors.size(); ++i) {
+            // 正序和逆序交替, 使key在短key和超过分组长度的长key之间切换
+            const HmacSha1Vector& v = vectors[round % 2 == 0 ? i : vectors.size() - 1 - i];
+            for (int repeat = 0; repeat < 2; ++repeat) {
+                context.SetKey(v.key.data(), v.key.size());
+                context.Calc(v.data.data(), v.data.size(), digest);
+                EXPECT_EQ(v.hex, ToLowerHex(digest, sizeof(digest)))
+                    << "round " << round << ", key of " << v.key.size() << " bytes";
+            }
+        }
+    }
+}
+
+} // namespace qcloud_cos
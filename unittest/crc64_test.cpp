@@ -0,0 +1,35 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "util/crc64.h"
+
+namespace qcloud_cos {
+
+TEST(Crc64Test, CheckValue) {
+    // CRC-64/XZ(ECMA-182)的标准校验值
+    EXPECT_EQ(0x995dc9bbdf1939faULL, Crc64::Calc(0, "123456789", 9));
+    EXPECT_EQ(0ULL, Crc64::Calc(0, "", 0));
+}
+
+TEST(Crc64Test, IncrementalAndCombine) {
+    std::string data;
+    for (int i = 0; i < 100000; ++i) {
+        data.push_back(static_cast<char>(i * 31 + i / 7));
+    }
+
+    // 覆盖查表和PCLMULQDQ两条路径以及各种长度的尾部
+    size_t lens[] = {1, 15, 16, 127, 128, 255, 256, 1000, 4097, 100000};
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i) {
+        size_t len = lens[i];
+        uint64_t whole = Crc64::Calc(0, data.data(), len);
+
+        size_t split = len / 3;
+        uint64_t first = Crc64::Calc(0, data.data(), split);
+        uint64_t second = Crc64::Calc(0, data.data() + split, len - split);
+        EXPECT_EQ(whole, Crc64::Calc(first, data.data() + split, len - split));
+        EXPECT_EQ(whole, Crc64::Combine(first, second, len - split));
+    }
+}
+
+} // namespace qcloud_cos
@@ -0,0 +1,103 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+
+#include "Poco/DigestStream.h"
+#include "Poco/MD5Engine.h"
+
+#include "util/md5_tee_stream.h"
+
+namespace qcloud_cos {
+
+namespace {
+
+std::string Md5Hex(const std::string& data) {
+    Poco::MD5Engine md5;
+    md5.update(data.data(), data.size());
+    return Poco::DigestEngine::digestToHex(md5.digest());
+}
+
+// 超过DigestTeeInputStreamBuf内部64K缓冲区的数据, 覆盖多次underflow
+std::string MakeData(size_t len) {
+    std::string data;
+    data.reserve(len);
+    for (size_t i = 0; i < len; ++i) {
+        data.push_back(static_cast<char>(i * 7 + i / 13));
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(Md5TeeStreamTest, OutputDigest) {
+    std::ostringstream sink;
+    Md5TeeOutputStream os(sink);
+    os << "hello world";
+    os.flush();
+    EXPECT_EQ("hello world", sink.str());
+    EXPECT_EQ("5eb63bbbe01eeed093cb22bb8f5acdc3", os.GetMd5());
+
+    // 混合put和write, 摘要与sink收到的数据一致
+    std::string data = MakeData(300000);
+    std::ostringstream big_sink;
+    Md5TeeOutputStream big_os(big_sink);
+    big_os.write(data.data(), 1000);
+    big_os.put(data[1000]);
+    big_os.write(data.data() + 1001, data.size() - 1001);
+    big_os.flush();
+    EXPECT_EQ(data, big_sink.str());
+    EXPECT_EQ(Md5Hex(data), big_os.GetMd5());
+}
+
+TEST(Md5TeeStreamTest, InputDigest) {
+    std::istringstream source("The quick brown fox jumps over the lazy dog");
+    Md5TeeInputStream is(source);
+    std::ostringstream out;
+    out << is.rdbuf();
+    EXPECT_EQ("The quick brown fox jumps over the lazy dog", out.str());
+    EXPECT_EQ("9e107d9d372bb6826bd81d3542a419d6", is.GetMd5());
+
+    std::string data = MakeData(300000);
+    std::istringstream big_source(data);
+    Md5TeeInputStream big_is(big_source);
+    std::string read_data;
+    char buf[8192];
+    while (big_is.read(buf, sizeof(buf)) || big_is.gcount() > 0) {
+        read_data.append(buf, big_is.gcount());
+    }
+    EXPECT_EQ(data, read_data);
+    EXPECT_EQ(Md5Hex(data), big_is.GetMd5());
+}
+
+TEST(Md5TeeStreamTest, InputSeekBeforeRead) {
+    std::istringstream source("abcdef");
+    Md5TeeInputStream is(source);
+
+    // 读取之前允许seek, 例如上传前计算长度
+    is.seekg(0, std::ios::end);
+    EXPECT_EQ(6, static_cast<int>(is.tellg()));
+    is.seekg(0, std::ios::beg);
+    EXPECT_TRUE(is.good());
+
+    std::ostringstream out;
+    out << is.rdbuf();
+    EXPECT_EQ("abcdef", out.str());
+    EXPECT_EQ("e80b5017098950fc58aad83c8c14978e", is.GetMd5());
+}
+
+TEST(Md5TeeStreamTest, InputSeekAfterReadFails) {
+    std::istringstream source("abcdef");
+    Md5TeeInputStream is(source);
+
+    char buf[3];
+    ASSERT_TRUE(is.read(buf, sizeof(buf)));
+    // tellg不移动读位置, 读取过程中仍然可用
+    EXPECT_EQ(3, static_cast<int>(is.tellg()));
+
+    // 读取开始后再seek会使摘要与读出的数据不一致, 必须失败
+    is.seekg(0, std::ios::beg);
+    EXPECT_TRUE(is.fail());
+}
+
+} // namespace qcloud_cos
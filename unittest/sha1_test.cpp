@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "util/sha1.h"
+
+namespace qcloud_cos {
+
+namespace {
+
+// FIPS 180-2附录中的测试向量
+struct Sha1Vector {
+    std::string data;
+    const char* hex;
+};
+
+std::vector<Sha1Vector> GetVectors() {
+    std::vector<Sha1Vector> vectors;
+    Sha1Vector empty = {"", "da39a3ee5e6b4b0d3255bfef95601890afd80709"};
+    Sha1Vector abc = {"abc", "a9993e364706816aba3e25717850c26c9cd0d89d"};
+    Sha1Vector two_blocks = {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+                             "84983e441c3bd26ebaae4aa1f95129e5e54670f1"};
+    Sha1Vector million_a = {std::string(1000000, 'a'),
+                            "34aa973cd4c4daa4f61eeb2bdbad27316534016f"};
+    vectors.push_back(empty);
+    vectors.push_back(abc);
+    vectors.push_back(two_blocks);
+    vectors.push_back(million_a);
+    return vectors;
+}
+
+} // namespace
+
+TEST(Sha1Test, KnownVectors) {
+    std::vector<Sha1Vector> vectors = GetVectors();
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        Sha1 sha1;
+        sha1.Append(vectors[i].data.data(), vectors[i].data.size());
+        EXPECT_EQ(vectors[i].hex, sha1.Final()) << "vector " << i;
+    }
+}
+
+TEST(Sha1Test, ChunkedAppendAndReset) {
+    std::vector<Sha1Vector> vectors = GetVectors();
+    // 同一个对象Reset后复用, 数据按不同的块大小分多次输入
+    Sha1 sha1;
+    size_t chunk_sizes[] = {1, 7, 63, 64, 65, 1000};
+    for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); ++c) {
+        for (size_t i = 0; i < vectors.size(); ++i) {
+            const std::string& data = vectors[i].data;
+            sha1.Reset();
+            for (size_t pos = 0; pos < data.size(); pos += chunk_sizes[c]) {
+                size_t len = std::min(chunk_sizes[c], data.size() - pos);
+                sha1.Append(data.data() + pos, len);
+            }
+            char hex[SHA_DIGESTSIZE * 2 + 1];
+            sha1.Final(hex);
+            EXPECT_STREQ(vectors[i].hex, hex) << "vector " << i << ", chunk " << chunk_sizes[c];
+        }
+    }
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+TEST(Sha1Test, DeprecatedApi) {
+    std::vector<Sha1Vector> vectors = GetVectors();
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        std::string data = vectors[i].data;
+        SHA_INFO sha_info;
+        ShaInit(&sha_info);
+        size_t half = data.size() / 2;
+        ShaUpdate(&sha_info, reinterpret_cast<SHA_BYTE*>(&data[0]), half);
+        ShaUpdate(&sha_info, reinterpret_cast<SHA_BYTE*>(&data[0]) + half, data.size() - half);
+        unsigned char digest[SHA_DIGESTSIZE];
+        ShaFinal(digest, &sha_info);
+
+        unsigned char hex[SHA_DIGESTSIZE * 2 + 1];
+        memset(hex, 'x', sizeof(hex));
+        ShaOutput(digest, hex);
+        EXPECT_STREQ(vectors[i].hex, reinterpret_cast<const char*>(hex)) << "vector " << i;
+    }
+    EXPECT_STREQ("SHA-1", ShaVersion());
+}
+#pragma GCC diagnostic pop
+
+} // namespace qcloud_cos